@@ -0,0 +1,69 @@
+// Число выделений памяти на цепочках выражений: operator new
+// подменён счётчиком. Цепочка с временными операндами сравнивается с
+// той же формулой на именованных константах, где каждая операция
+// вынуждена копировать левый операнд.
+//
+//   g++ -std=c++20 -O2 bench/alloc_count.cpp -o alloc_count
+//   ./alloc_count
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+#include "../biginteger.h"
+
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+
+// Среднее число выделений на один вызов f
+template <typename F>
+double countAllocations(F f, int reps) {
+  size_t before = allocations;
+  for (int i = 0; i < reps; ++i) {
+    f();
+  }
+  return double(allocations - before) / reps;
+}
+
+int main() {
+  std::string digits(190, '7');
+  BigInteger a(digits), b(digits), c(digits), e(digits), r;
+  double chained =
+      countAllocations([&] { r = a * b + c * e - a * c; }, 1000);
+  double named = countAllocations(
+      [&] {
+        const BigInteger ab = a * b, ce = c * e, ac = a * c;
+        const BigInteger sum = ab + ce;
+        r = sum - ac;
+      },
+      1000);
+  std::printf("a * b + c * e - a * c (190 digits): %.2f, named: %.2f\n",
+              chained, named);
+
+  Rational x = Rational(a) / Rational(b + 1_bi);
+  Rational y = Rational(c) / Rational(e - 1_bi);
+  Rational z;
+  chained = countAllocations([&] { z = x * y + y * x - x; }, 100);
+  named = countAllocations(
+      [&] {
+        const Rational xy = x * y, yx = y * x;
+        const Rational sum = xy + yx;
+        z = sum - x;
+      },
+      100);
+  std::printf("Rational x * y + y * x - x: %.2f, named: %.2f\n", chained,
+              named);
+}
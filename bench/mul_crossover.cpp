@@ -0,0 +1,94 @@
+// Пороги умножения BigInteger: время одного верхнего уровня каждого
+// алгоритма (подпроизведения идут обычной диспетчеризацией) на
+// квадратных произведениях n x n лимбов вокруг KARATSUBA_THRESHOLD,
+// TOOM3_THRESHOLD и NTT_THRESHOLD.
+//
+//   g++ -std=c++20 -O2 -march=native bench/mul_crossover.cpp -o mul_crossover
+//   ./mul_crossover
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "../biginteger.h"
+
+struct BigIntegerBenchmark {
+  using Kernel = void (*)(uint64_t*, const uint64_t*, size_t, const uint64_t*,
+                          size_t);
+
+  static constexpr Kernel basecase = BigInteger::mulBasecase;
+  static constexpr Kernel karatsuba = BigInteger::mulKaratsuba;
+  static constexpr Kernel toom3 = BigInteger::mulToom3;
+  static constexpr Kernel ntt = BigInteger::mulNTT;
+
+  static constexpr size_t karatsubaThreshold = BigInteger::KARATSUBA_THRESHOLD;
+  static constexpr size_t toom3Threshold = BigInteger::TOOM3_THRESHOLD;
+  static constexpr size_t nttThreshold = BigInteger::NTT_THRESHOLD;
+};
+
+// Лучшее из нескольких прогонов, в микросекундах
+double timeKernel(BigIntegerBenchmark::Kernel kernel, size_t n) {
+  std::mt19937_64 rng(n);
+  std::vector<uint64_t> a(n), b(n), r(2 * n);
+  for (size_t i = 0; i < n; ++i) {
+    a[i] = rng();
+    b[i] = rng();
+  }
+  size_t reps = std::max<size_t>(1, 2000000 / (n * n + 1));
+  double best = 1e300;
+  for (int run = 0; run < 5; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < reps; ++i) {
+      kernel(r.data(), a.data(), n, b.data(), n);
+    }
+    std::chrono::duration<double, std::micro> spent =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, spent.count() / reps);
+  }
+  return best;
+}
+
+// Сравнение двух алгоритмов на сетке размеров; первый размер, с
+// которого второй стабильно быстрее, - точка пересечения
+void crossover(const char* name, BigIntegerBenchmark::Kernel slow,
+               const char* slow_name, BigIntegerBenchmark::Kernel fast,
+               const char* fast_name, const std::vector<size_t>& sizes,
+               size_t threshold) {
+  std::printf("%s (порог в biginteger.h: %zu лимбов)\n", name, threshold);
+  std::printf("%8s %14s %14s %8s\n", "limbs", slow_name, fast_name, "ratio");
+  size_t found = 0;
+  for (size_t n : sizes) {
+    double t_slow = timeKernel(slow, n);
+    double t_fast = timeKernel(fast, n);
+    std::printf("%8zu %12.2fus %12.2fus %8.2f\n", n, t_slow, t_fast,
+                t_slow / t_fast);
+    if (t_fast < t_slow) {
+      if (found == 0) {
+        found = n;
+      }
+    } else {
+      found = 0;
+    }
+  }
+  if (found != 0) {
+    std::printf("пересечение: ~%zu лимбов\n\n", found);
+  } else {
+    std::printf("пересечение: выше сетки\n\n");
+  }
+}
+
+int main() {
+  using B = BigIntegerBenchmark;
+  crossover("Карацуба против столбика", B::basecase, "basecase",
+            B::karatsuba, "karatsuba",
+            {8, 12, 16, 20, 24, 28, 32, 40, 48, 64, 96, 128},
+            B::karatsubaThreshold);
+  crossover("Тоом-3 против Карацубы", B::karatsuba, "karatsuba", B::toom3,
+            "toom3",
+            {200, 300, 400, 500, 600, 700, 800, 1000, 1200, 1500, 2000},
+            B::toom3Threshold);
+  crossover("NTT против Тоома-3", B::toom3, "toom3", B::ntt, "ntt",
+            {10000, 16000, 20000, 28000, 33000, 36000, 40000, 44000, 66000,
+             72000, 80000, 100000},
+            B::nttThreshold);
+}
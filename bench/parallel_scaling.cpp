@@ -0,0 +1,69 @@
+// Масштабирование умножения и деления BigInteger по числу потоков
+// (BigInteger::setThreadCount): 1, 2, 4, 8 и 16 потоков на числах в
+// миллион десятичных цифр и больше. Ускорение считается от времени
+// на одном потоке; результаты сверяются с однопоточными.
+//
+//   g++ -std=c++20 -O2 -pthread bench/parallel_scaling.cpp -o scaling
+//   ./scaling [digits]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+
+#include "../biginteger.h"
+
+BigInteger randomNumber(size_t digits, uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::string str(digits, '0');
+  for (char& c : str) {
+    c = char('0' + rng() % 10);
+  }
+  str[0] = '7';
+  return BigInteger(str);
+}
+
+// Лучшее из трёх прогонов, в миллисекундах
+double bestTime(const std::function<void()>& run) {
+  double best = 1e300;
+  for (int i = 0; i < 3; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    std::chrono::duration<double, std::milli> spent =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, spent.count());
+  }
+  return best;
+}
+
+void scale(const char* name, const std::function<BigInteger()>& op) {
+  std::printf("%s\n%8s %12s %8s\n", name, "threads", "ms", "speedup");
+  BigInteger::setThreadCount(1);
+  BigInteger expected = op();
+  double base = 0;
+  for (size_t threads : {1, 2, 4, 8, 16}) {
+    BigInteger::setThreadCount(threads);
+    BigInteger result;
+    double ms = bestTime([&] { result = op(); });
+    if (threads == 1) {
+      base = ms;
+    }
+    std::printf("%8zu %12.1f %8.2f%s\n", threads, ms, base / ms,
+                result == expected ? "" : "  MISMATCH");
+  }
+  std::printf("\n");
+}
+
+int main(int argc, char** argv) {
+  size_t digits = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+  std::printf("hardware threads: %u, operands: %zu digits\n\n",
+              std::thread::hardware_concurrency(), digits);
+  BigInteger a = randomNumber(digits, 1), b = randomNumber(digits, 2);
+  BigInteger c = randomNumber(digits / 8, 3);
+  scale("a * b (NTT)", [&] { return a * b; });
+  scale("a * c (unbalanced, Toom-3/Karatsuba)", [&] { return a * c; });
+  BigInteger ab = a * b;
+  scale("(a * b) / b (Burnikel-Ziegler)", [&] { return ab / b; });
+  BigInteger::setThreadCount(1);
+}
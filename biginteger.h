@@ -1,12 +1,35 @@
-﻿#include <cstring>
+﻿#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
 #include <iostream>
+#include <mutex>
+#include <span>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
 
 class BigInteger;
 BigInteger operator+(const BigInteger& a, const BigInteger& b);
+BigInteger operator+(BigInteger&& a, const BigInteger& b);
+BigInteger operator+(const BigInteger& a, BigInteger&& b);
+BigInteger operator+(BigInteger&& a, BigInteger&& b);
 BigInteger operator-(const BigInteger& a, const BigInteger& b);
+BigInteger operator-(BigInteger&& a, const BigInteger& b);
 BigInteger operator*(const BigInteger& a, const BigInteger& b);
+BigInteger operator*(BigInteger&& a, const BigInteger& b);
+BigInteger operator*(const BigInteger& a, BigInteger&& b);
+BigInteger operator*(BigInteger&& a, BigInteger&& b);
 bool operator<(const BigInteger& a, const BigInteger& b);
 bool operator>=(const BigInteger& a, const BigInteger& b);
 bool operator>(const BigInteger& a, const BigInteger& b);
@@ -17,187 +40,1934 @@ std::ostream& operator<<(std::ostream& out, const BigInteger& bi);
 std::istream& operator>>(std::istream& in, BigInteger& bi);
 BigInteger operator""_bi(unsigned long long number);
 BigInteger operator""_bi(const char* number, size_t);
+void addmul(BigInteger& acc, const BigInteger& a, const BigInteger& b);
+void submul(BigInteger& acc, const BigInteger& a, const BigInteger& b);
+std::pair<BigInteger, BigInteger> divmod(const BigInteger& a,
+                                         const BigInteger& b);
+BigInteger gcd(BigInteger a, BigInteger b);
+template <typename It>
+BigInteger product(It first, It last);
+template <typename Range>
+BigInteger product(const Range& range);
+BigInteger factorial(uint64_t n);
+BigInteger binomial(uint64_t n, uint64_t k);
+BigInteger primorial(uint64_t n);
+BigInteger isqrt(const BigInteger& n);
+BigInteger iroot(const BigInteger& n, uint64_t k);
+bool isPerfectSquare(const BigInteger& n);
 
 class BigInteger {
   friend bool operator<(const BigInteger& a, const BigInteger& b);
   friend bool operator==(const BigInteger& a, const BigInteger& b);
   friend std::ostream& operator<<(std::ostream& out, const BigInteger& bi);
+  friend void addmul(BigInteger& acc, const BigInteger& a, const BigInteger& b);
+  friend void submul(BigInteger& acc, const BigInteger& a, const BigInteger& b);
+  friend std::pair<BigInteger, BigInteger> divmod(const BigInteger& a,
+                                                  const BigInteger& b);
+  friend BigInteger gcd(BigInteger a, BigInteger b);
+  friend BigInteger factorial(uint64_t n);
+  friend BigInteger binomial(uint64_t n, uint64_t k);
+  friend BigInteger primorial(uint64_t n);
+  friend BigInteger isqrt(const BigInteger& n);
+  friend BigInteger iroot(const BigInteger& n, uint64_t k);
+  friend bool isPerfectSquare(const BigInteger& n);
+  friend class Rational;
+  friend class MontgomeryContext;
+  friend class BarrettReducer;
+  friend class BigIntegerView;
+  // Доступ к ядрам умножения для bench/mul_crossover.cpp
+  friend struct BigIntegerBenchmark;
 
  private:
-  std::vector<long long> digits;
+  // Лимбы BigInteger: первые INLINE_CAPACITY хранятся в самом объекте,
+  // в кучу массив уходит только при росте
+  class LimbVector {
+   private:
+    static const size_t INLINE_CAPACITY = 4;
+
+    size_t sz = 0;
+    size_t cap = INLINE_CAPACITY;
+    uint64_t* arr = local;
+    uint64_t local[INLINE_CAPACITY];
+
+    bool isInline() const { return arr == local; }
+
+    // Перевыделить массив на new_cap лимбов
+    void realloc(size_t new_cap) {
+      uint64_t* new_arr = new uint64_t[new_cap];
+      std::copy(arr, arr + sz, new_arr);
+      if (!isInline()) {
+        delete[] arr;
+      }
+      arr = new_arr;
+      cap = new_cap;
+    }
+
+   public:
+    LimbVector() = default;
+
+    LimbVector(const LimbVector& other) { assign(other.begin(), other.end()); }
+
+    LimbVector(LimbVector&& other) noexcept { *this = std::move(other); }
+
+    LimbVector& operator=(const LimbVector& other) {
+      if (this != &other) {
+        assign(other.begin(), other.end());
+      }
+      return *this;
+    }
+
+    LimbVector& operator=(LimbVector&& other) noexcept {
+      if (this == &other) {
+        return *this;
+      }
+      if (other.isInline()) {
+        std::copy(other.begin(), other.end(), arr);
+        sz = other.sz;
+      } else {
+        if (!isInline()) {
+          delete[] arr;
+        }
+        arr = other.arr;
+        sz = other.sz;
+        cap = other.cap;
+        other.arr = other.local;
+        other.cap = INLINE_CAPACITY;
+      }
+      other.sz = 0;
+      return *this;
+    }
+
+    ~LimbVector() {
+      if (!isInline()) {
+        delete[] arr;
+      }
+    }
+
+    void swap(LimbVector& other) {
+      LimbVector temp = std::move(other);
+      other = std::move(*this);
+      *this = std::move(temp);
+    }
+
+    size_t size() const { return sz; }
+
+    uint64_t* data() { return arr; }
+
+    const uint64_t* data() const { return arr; }
+
+    uint64_t* begin() { return arr; }
+
+    const uint64_t* begin() const { return arr; }
+
+    uint64_t* end() { return arr + sz; }
+
+    const uint64_t* end() const { return arr + sz; }
+
+    uint64_t& operator[](size_t index) { return arr[index]; }
+
+    const uint64_t& operator[](size_t index) const { return arr[index]; }
+
+    uint64_t& back() { return arr[sz - 1]; }
+
+    const uint64_t& back() const { return arr[sz - 1]; }
+
+    void reserve(size_t n) {
+      if (n > cap) {
+        realloc(std::max(n, 2 * cap));
+      }
+    }
+
+    void push_back(uint64_t value) {
+      reserve(sz + 1);
+      arr[sz++] = value;
+    }
+
+    void pop_back() { --sz; }
+
+    void resize(size_t n, uint64_t value = 0) {
+      reserve(n);
+      if (n > sz) {
+        std::fill(arr + sz, arr + n, value);
+      }
+      sz = n;
+    }
+
+    void assign(size_t n, uint64_t value) {
+      sz = 0;
+      resize(n, value);
+    }
+
+    void assign(const uint64_t* first, const uint64_t* last) {
+      sz = 0;
+      reserve(last - first);
+      std::copy(first, last, arr);
+      sz = last - first;
+    }
+
+    // Вставить k копий value перед pos
+    void insert(uint64_t* pos, size_t k, uint64_t value) {
+      size_t index = pos - arr;
+      reserve(sz + k);
+      std::copy_backward(arr + index, arr + sz, arr + sz + k);
+      std::fill(arr + index, arr + index + k, value);
+      sz += k;
+    }
+  };
+
+  // Стек временных лимбов для ядер умножения и деления, свой у каждого
+  // потока. Память берётся и возвращается строго по вложенности кадров
+  // (Frame), поэтому выделение сводится к сдвигу указателя, а куча
+  // затрагивается, только пока арена растёт до пиковой глубины операции
+  class ScratchArena {
+   private:
+    static const size_t MIN_BLOCK = 1024;
+    static const size_t MAX_KEPT = size_t(1) << 16;
+
+    // Блоки не двигаются и удваиваются по размеру
+    std::vector<std::vector<uint64_t>> blocks;
+    size_t block = 0;
+    size_t used = 0;
+
+    uint64_t* take(size_t n) {
+      while (block < blocks.size() && used + n > blocks[block].size()) {
+        ++block;
+        used = 0;
+      }
+      if (block == blocks.size()) {
+        size_t size = blocks.empty() ? MIN_BLOCK : 2 * blocks.back().size();
+        blocks.emplace_back(std::max(size, n));
+      }
+      uint64_t* result = blocks[block].data() + used;
+      used += n;
+      return result;
+    }
+
+   public:
+    static ScratchArena& local() {
+      thread_local ScratchArena arena;
+      return arena;
+    }
+
+    // Вне кадров арена держит не больше MAX_KEPT лимбов: память пиковой
+    // глубины после одной большой операции возвращается куче
+    void trim() {
+      size_t kept = 0, count = 0;
+      while (count < blocks.size() && kept + blocks[count].size() <= MAX_KEPT) {
+        kept += blocks[count].size();
+        ++count;
+      }
+      blocks.resize(count);
+    }
+
+    // Всё взятое через кадр возвращается арене при его разрушении
+    class Frame {
+     private:
+      ScratchArena& arena;
+      size_t block;
+      size_t used;
+
+     public:
+      Frame()
+          : arena(ScratchArena::local()),
+            block(arena.block),
+            used(arena.used) {}
+
+      Frame(const Frame&) = delete;
+      Frame& operator=(const Frame&) = delete;
+
+      ~Frame() {
+        arena.block = block;
+        arena.used = used;
+        if (block == 0 && used == 0) {
+          arena.trim();
+        }
+      }
+
+      uint64_t* take(size_t n) { return arena.take(n); }
+    };
+  };
+
+  using uint128 = unsigned __int128;
+
+  // Лимбы по основанию 2^64, младшие первыми
+  LimbVector digits;
   bool isNegative = false;
-  int static const MOD = 1000000000;
-  int static const POW = 9;
+  // Десятичные блоки по POW цифр (DEC_MOD = 10^POW) для ввода и вывода
+  uint64_t static constexpr DEC_MOD = 10000000000000000000ULL;
+  int static const POW = 19;
   int static const BASE = 10;
+  // Пороги умножения сняты bench/mul_crossover.cpp на x86-64 (Xeon,
+  // g++ 12, -O2 -march=native): первая длина, с которой алгоритм
+  // стабильно быстрее предыдущего. NTT идёт ступенями по степеням
+  // двойки и выше 44000 лимбов выигрывает и сразу за ступенью.
+  // Пороги (в лимбах), начиная с которых включаются Карацуба и Тоом-3
+  size_t static const KARATSUBA_THRESHOLD = 20;
+  size_t static const TOOM3_THRESHOLD = 500;
+  // Порог NTT и максимальная суммарная длина множителей (ограничена КТО)
+  size_t static const NTT_THRESHOLD = 44000;
+  size_t static const NTT_MAX_LENGTH = size_t(1) << 21;
+  // Длина меньшего множителя (в лимбах), с которой подпроизведения
+  // Карацубы, Тоома-3 и NTT раздаются потокам
+  size_t static const PARALLEL_THRESHOLD = 2000;
+  // Порог (в лимбах) деления Бурникеля-Циглера
+  size_t static const BZ_THRESHOLD = 60;
+  // Порог (в десятичных блоках) рекурсивного перевода между системами
+  size_t static const RADIX_THRESHOLD = 40;
+  // Длина (в лимбах), с которой сложение и вычитание идут векторно
+  size_t static const SIMD_THRESHOLD = 16;
+  // Длина (в лимбах), с которой НОД переходит с Лемера на бинарный
+  size_t static const GCD_BINARY_THRESHOLD = 2;
+  // Длина листа (в лимбах) в произведениях машинных слов
+  size_t static const PRODUCT_LEAF = 16;
+  // C(n, k) раскладывается на простые при k >= n / BINOMIAL_SIEVE_RATIO,
+  // иначе n! / (n - k)! делится на k!
+  uint64_t static const BINOMIAL_SIEVE_RATIO = 64;
+  // Версия двоичного формата и длина его заголовка в байтах
+  uint8_t static const SERIAL_VERSION = 1;
+  size_t static const SERIAL_HEADER = 8;
+  // Размер блока (в лимбах) при записи в поток и чтении из него
+  size_t static constexpr SERIAL_BLOCK = 512;
+
+  // Удалить нули в конце
+  void delZero() {
+    int sz = digits.size() - 1;
+    while (sz >= 0 && digits[sz] == 0) {
+      digits.pop_back();
+      --sz;
+    }
+  }
+
+  // Привести к каноническому виду: без ведущих нулей и без "-0"
+  void beautify() {
+    delZero();
+    if (digits.size() == 0) {
+      isNegative = false;
+    }
+  }
+
+  // <= по модулю
+  bool absLessEq(const BigInteger& other) const {
+    if (digits.size() != other.digits.size()) {
+      return digits.size() < other.digits.size();
+    }
+    for (int i = int(digits.size() - 1); i >= 0; --i) {
+      if (digits[i] != other.digits[i]) {
+        return digits[i] < other.digits[i];
+      }
+    }
+    return true;
+  }
+
+  // Увеличить модуль на 1
+  void increaseAbs() {
+    for (int i = 0; i < int(digits.size()); ++i) {
+      if (digits[i] == UINT64_MAX) {
+        digits[i] = 0;
+      } else {
+        ++digits[i];
+        break;
+      }
+    }
+  }
+
+  // Уменьшить модуль на 1
+  void decreaseAbs() {
+    for (int i = 0; i < int(digits.size()); ++i) {
+      if (digits[i] == 0) {
+        digits[i] = UINT64_MAX;
+      } else {
+        --digits[i];
+        break;
+      }
+    }
+  }
+
+  // Число из лимбов [p, p + n)
+  static BigInteger fromLimbs(const uint64_t* p, size_t n) {
+    BigInteger result;
+    result.digits.assign(p, p + n);
+    result.delZero();
+    return result;
+  }
+
+  // Лимбы [from, from + len) числа a
+  static BigInteger sliceLimbs(const BigInteger& a, size_t from, size_t len) {
+    if (from >= a.digits.size()) {
+      return BigInteger();
+    }
+    len = std::min(len, a.digits.size() - from);
+    return fromLimbs(a.digits.data() + from, len);
+  }
+
+  // Сдвиг на k лимбов влево (умножение на 2^(64k))
+  void shiftLimbs(size_t k) {
+    if (digits.size() != 0) {
+      digits.insert(digits.begin(), k, 0);
+    }
+  }
+
+  // Умножение модуля на 2^s, 0 <= s < 64
+  void shiftLeftBits(int s) {
+    uint64_t out =
+        shiftLeftLimbs(digits.data(), digits.data(), digits.size(), s);
+    if (out != 0) {
+      digits.push_back(out);
+    }
+  }
+
+  // Деление модуля на 2^s нацело, 0 <= s < 64
+  void shiftRightBits(int s) {
+    shiftRightLimbs(digits.data(), digits.data(), digits.size(), s);
+    beautify();
+  }
+
+  // Слово из 8 байт little-endian и обратно
+  static uint64_t loadWord(const std::byte* p) {
+    uint64_t x;
+    std::memcpy(&x, p, sizeof(x));
+    if constexpr (std::endian::native == std::endian::big) {
+      x = __builtin_bswap64(x);
+    }
+    return x;
+  }
+
+  static void storeWord(std::byte* p, uint64_t x) {
+    if constexpr (std::endian::native == std::endian::big) {
+      x = __builtin_bswap64(x);
+    }
+    std::memcpy(p, &x, sizeof(x));
+  }
+
+  // n лимбов в little-endian и обратно
+  static void storeLimbs(std::byte* p, const uint64_t* a, size_t n) {
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(p, a, 8 * n);
+    } else {
+      for (size_t i = 0; i < n; ++i) {
+        storeWord(p + 8 * i, a[i]);
+      }
+    }
+  }
+
+  static void loadLimbs(uint64_t* r, const std::byte* p, size_t n) {
+    if constexpr (std::endian::native == std::endian::little) {
+      std::memcpy(r, p, 8 * n);
+    } else {
+      for (size_t i = 0; i < n; ++i) {
+        r[i] = loadWord(p + 8 * i);
+      }
+    }
+  }
+
+  // Заголовок: версия, знак, два нулевых байта, число лимбов (32 бита)
+  void writeHeader(std::byte* p) const {
+    uint64_t count = digits.size();
+    p[0] = std::byte{SERIAL_VERSION};
+    p[1] = std::byte{isNegative};
+    p[2] = p[3] = std::byte{0};
+    for (size_t i = 0; i < 4; ++i) {
+      p[4 + i] = std::byte(count >> (8 * i));
+    }
+  }
+
+  // false, если версия неизвестна или поля заголовка некорректны
+  static bool readHeader(const std::byte* p, bool& negative, size_t& count) {
+    if (p[0] != std::byte{SERIAL_VERSION} || p[1] > std::byte{1} ||
+        p[2] != std::byte{0} || p[3] != std::byte{0}) {
+      return false;
+    }
+    negative = (p[1] == std::byte{1});
+    count = 0;
+    for (size_t i = 0; i < 4; ++i) {
+      count |= std::to_integer<size_t>(p[4 + i]) << (8 * i);
+    }
+    return !(negative && count == 0);
+  }
+
+  // Умножение модуля на 2^s
+  void shiftLeft(size_t s) {
+    shiftLeftBits(s % 64);
+    shiftLimbs(s / 64);
+  }
+
+  // Деление модуля на 2^s нацело
+  void shiftRight(size_t s) {
+    size_t k = std::min(s / 64, digits.size());
+    std::copy(digits.data() + k, digits.data() + digits.size(),
+              digits.data());
+    digits.resize(digits.size() - k);
+    shiftRightBits(s % 64);
+  }
+
+  // Обратное к нормализованному d: floor((2^128 - 1) / d) - 2^64
+  static uint64_t reciprocal(uint64_t d) {
+    return uint64_t(~uint128(0) / d);
+  }
+
+  // (u1:u0) / d для нормализованного d и u1 < d по Мёллеру-Гранлунду:
+  // два умножения вместо 128-битного деления
+  static uint64_t divStep(uint64_t u1, uint64_t u0, uint64_t d, uint64_t v,
+                          uint64_t& rem) {
+    uint128 q = uint128(v) * u1 + ((uint128(u1) << 64) | u0);
+    uint64_t q1 = uint64_t(q >> 64) + 1;
+    uint64_t r = u0 - q1 * d;
+    if (r > uint64_t(q)) {
+      --q1;
+      r += d;
+    }
+    if (r >= d) {
+      ++q1;
+      r -= d;
+    }
+    rem = r;
+    return q1;
+  }
+
+  // r[0..n) /= d, возвращает остаток
+  static uint64_t divSmallLimbs(uint64_t* r, size_t n, uint64_t d) {
+    int shift = __builtin_clzll(d);
+    uint64_t dn = d << shift;
+    uint64_t v = reciprocal(dn);
+    uint64_t rem = 0;
+    for (size_t i = n; i > 0; --i) {
+      uint64_t u1 = rem << shift;
+      if (shift != 0) {
+        u1 |= r[i - 1] >> (64 - shift);
+      }
+      r[i - 1] = divStep(u1, r[i - 1] << shift, dn, v, rem);
+      rem >>= shift;
+    }
+    return rem;
+  }
+
+  // a[0..n) % d без изменения a
+  static uint64_t modSmallLimbs(const uint64_t* a, size_t n, uint64_t d) {
+    int shift = __builtin_clzll(d);
+    uint64_t dn = d << shift;
+    uint64_t v = reciprocal(dn);
+    uint64_t rem = 0;
+    for (size_t i = n; i > 0; --i) {
+      uint64_t u1 = rem << shift;
+      if (shift != 0) {
+        u1 |= a[i - 1] >> (64 - shift);
+      }
+      divStep(u1, a[i - 1] << shift, dn, v, rem);
+      rem >>= shift;
+    }
+    return rem;
+  }
+
+  // Деление модуля на короткое число d, возвращает остаток
+  uint64_t divmodSmall(uint64_t d) {
+    uint64_t rem = divSmallLimbs(digits.data(), digits.size(), d);
+    delZero();
+    if (digits.size() == 0) {
+      isNegative = false;
+    }
+    return rem;
+  }
+
+  // Умножение модуля на короткое число x
+  void mulSmall(uint64_t x) {
+    if (x == 0) {
+      *this = BigInteger();
+      return;
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < digits.size(); ++i) {
+      uint128 cur = uint128(digits[i]) * x + carry;
+      digits[i] = uint64_t(cur);
+      carry = uint64_t(cur >> 64);
+    }
+    if (carry != 0) {
+      digits.push_back(carry);
+    }
+  }
+
+  // Прибавление короткого числа x к модулю
+  void addSmall(uint64_t x) {
+    for (size_t i = 0; i < digits.size() && x != 0; ++i) {
+      digits[i] += x;
+      x = (digits[i] < x ? 1 : 0);
+    }
+    if (x != 0) {
+      digits.push_back(x);
+    }
+  }
+
+  // Сравнение модулей одинаковой длины n
+  static int cmpLimbs(const uint64_t* a, const uint64_t* b, size_t n) {
+    for (size_t i = n; i > 0; --i) {
+      if (a[i - 1] != b[i - 1]) {
+        return a[i - 1] < b[i - 1] ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  // Векторные расширения, доступные процессору; проверяются один раз
+  enum class SimdLevel { SCALAR, AVX2, AVX512 };
+
+  static SimdLevel simdLevel() {
+    static const SimdLevel level = [] {
+#if defined(__x86_64__)
+      __builtin_cpu_init();
+      if (__builtin_cpu_supports("avx512f")) {
+        return SimdLevel::AVX512;
+      }
+      if (__builtin_cpu_supports("avx2")) {
+        return SimdLevel::AVX2;
+      }
+#endif
+      return SimdLevel::SCALAR;
+    }();
+    return level;
+  }
+
+#if defined(__x86_64__)
+  // r[0..n) += a[0..n) (или -=) блоками по 8 лимбов. Дорожки считаются
+  // независимо, затем переносы между ними разрешаются одним сложением
+  // масок: перенос входит в дорожку, если его породила предыдущая
+  // дорожка или он прошёл через дорожки, равные 2^64 - 1 (при вычитании
+  // нулю). Возвращает число обработанных лимбов, перенос - в carry
+  template <bool subtract>
+  __attribute__((target("avx512f"))) static size_t addSubAvx512(
+      uint64_t* r, const uint64_t* a, size_t n, uint64_t& carry) {
+    const __m512i ones = _mm512_set1_epi64(-1);
+    unsigned in = unsigned(carry);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+      __m512i x = _mm512_loadu_si512(r + i);
+      __m512i y = _mm512_loadu_si512(a + i);
+      __m512i s;
+      unsigned generate, propagate;
+      if (subtract) {
+        s = _mm512_sub_epi64(x, y);
+        generate = _mm512_cmplt_epu64_mask(x, y);
+        propagate = _mm512_cmpeq_epi64_mask(s, _mm512_setzero_si512());
+      } else {
+        s = _mm512_add_epi64(x, y);
+        generate = _mm512_cmplt_epu64_mask(s, x);
+        propagate = _mm512_cmpeq_epi64_mask(s, ones);
+      }
+      unsigned sum = ((generate << 1) | in) + propagate;
+      __mmask8 lanes = __mmask8(sum ^ propagate);
+      in = sum >> 8;
+      if (subtract) {
+        s = _mm512_mask_add_epi64(s, lanes, s, ones);
+      } else {
+        s = _mm512_mask_sub_epi64(s, lanes, s, ones);
+      }
+      _mm512_storeu_si512(r + i, s);
+    }
+    carry = in;
+    return i;
+  }
+
+  // То же блоками по 4 лимба; беззнаковое сравнение через сдвиг знака
+  template <bool subtract>
+  __attribute__((target("avx2"))) static size_t addSubAvx2(
+      uint64_t* r, const uint64_t* a, size_t n, uint64_t& carry) {
+    const __m256i ones = _mm256_set1_epi64x(-1);
+    const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+    const __m256i lane_shift = _mm256_set_epi64x(3, 2, 1, 0);
+    unsigned in = unsigned(carry);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+      __m256i x = _mm256_loadu_si256(reinterpret_cast<__m256i*>(r + i));
+      __m256i y =
+          _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+      __m256i s, generate, propagate;
+      if (subtract) {
+        s = _mm256_sub_epi64(x, y);
+        generate = _mm256_cmpgt_epi64(_mm256_xor_si256(y, bias),
+                                      _mm256_xor_si256(x, bias));
+        propagate = _mm256_cmpeq_epi64(s, _mm256_setzero_si256());
+      } else {
+        s = _mm256_add_epi64(x, y);
+        generate = _mm256_cmpgt_epi64(_mm256_xor_si256(x, bias),
+                                      _mm256_xor_si256(s, bias));
+        propagate = _mm256_cmpeq_epi64(s, ones);
+      }
+      unsigned g = _mm256_movemask_pd(_mm256_castsi256_pd(generate));
+      unsigned p = _mm256_movemask_pd(_mm256_castsi256_pd(propagate));
+      unsigned sum = ((g << 1) | in) + p;
+      in = sum >> 4;
+      // Биты масок переносов разворачиваются в дорожки со значением 0 или 1
+      __m256i lanes = _mm256_set1_epi64x(sum ^ p);
+      lanes = _mm256_srlv_epi64(lanes, lane_shift);
+      lanes = _mm256_and_si256(lanes, _mm256_set1_epi64x(1));
+      s = (subtract ? _mm256_sub_epi64(s, lanes) : _mm256_add_epi64(s, lanes));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(r + i), s);
+    }
+    carry = in;
+    return i;
+  }
+#endif
+
+  // Векторная часть r[0..n) += a[0..n) (или -=): возвращает число
+  // обработанных лимбов, перенос (заём) - в carry
+  template <bool subtract>
+  static size_t addSubVector(uint64_t* r, const uint64_t* a, size_t n,
+                             uint64_t& carry) {
+#if defined(__x86_64__)
+    if (n >= SIMD_THRESHOLD) {
+      switch (simdLevel()) {
+        case SimdLevel::AVX512:
+          return addSubAvx512<subtract>(r, a, n, carry);
+        case SimdLevel::AVX2:
+          return addSubAvx2<subtract>(r, a, n, carry);
+        default:
+          break;
+      }
+    }
+#endif
+    return 0;
+  }
+
+  // r[0..rn) += a[0..an), an <= rn; возвращает перенос из старшего лимба
+  static uint64_t addLimbs(uint64_t* r, size_t rn, const uint64_t* a,
+                           size_t an) {
+    uint64_t carry = 0;
+    size_t i = addSubVector<false>(r, a, an, carry);
+    for (; i < an; ++i) {
+      uint128 cur = uint128(r[i]) + a[i] + carry;
+      r[i] = uint64_t(cur);
+      carry = uint64_t(cur >> 64);
+    }
+    for (; carry != 0 && i < rn; ++i) {
+      carry = (++r[i] == 0);
+    }
+    return carry;
+  }
+
+  // r[0..rn) -= a[0..an), an <= rn; возвращает заём из старшего лимба
+  static uint64_t subLimbs(uint64_t* r, size_t rn, const uint64_t* a,
+                           size_t an) {
+    uint64_t borrow = 0;
+    size_t i = addSubVector<true>(r, a, an, borrow);
+    for (; i < an; ++i) {
+      uint128 cur = uint128(r[i]) - a[i] - borrow;
+      r[i] = uint64_t(cur);
+      borrow = uint64_t(cur >> 64) & 1;
+    }
+    for (; borrow != 0 && i < rn; ++i) {
+      borrow = (r[i]-- == 0);
+    }
+    return borrow;
+  }
+
+  // r[0..n) = a[0..n) * 2^s, 0 <= s < 64; возвращает выдвинутые биты
+  static uint64_t shiftLeftLimbs(uint64_t* r, const uint64_t* a, size_t n,
+                                 int s) {
+    uint64_t out = 0;
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t cur = a[i];
+      r[i] = (cur << s) | out;
+      out = (s == 0 ? 0 : cur >> (64 - s));
+    }
+    return out;
+  }
+
+  // r[0..n) = a[0..n) / 2^s, 0 <= s < 64
+  static void shiftRightLimbs(uint64_t* r, const uint64_t* a, size_t n,
+                              int s) {
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t high = (i + 1 < n && s != 0 ? a[i + 1] << (64 - s) : 0);
+      r[i] = (a[i] >> s) | high;
+    }
+  }
+
+  // r[0..n) += a[0..n) * x, возвращает перенос
+  static uint64_t addMulRow(uint64_t* r, const uint64_t* a, size_t n,
+                            uint64_t x) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < n; ++i) {
+      uint128 cur = uint128(a[i]) * x + r[i] + carry;
+      r[i] = uint64_t(cur);
+      carry = uint64_t(cur >> 64);
+    }
+    return carry;
+  }
+
+  // r[0..n) -= a[0..n) * x, возвращает заём из старшего лимба
+  static uint64_t subMulRow(uint64_t* r, const uint64_t* a, size_t n,
+                            uint64_t x) {
+    uint64_t carry = 0, borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+      uint128 prod = uint128(a[i]) * x + carry;
+      carry = uint64_t(prod >> 64);
+      uint128 cur = uint128(r[i]) - uint64_t(prod) - borrow;
+      r[i] = uint64_t(cur);
+      borrow = uint64_t(cur >> 64) & 1;
+    }
+    return carry + borrow;
+  }
+
+  // Разрешённое число потоков и число уже занятых дополнительных
+  static std::atomic<size_t>& threadLimit() {
+    static std::atomic<size_t> limit{1};
+    return limit;
+  }
+
+  static std::atomic<size_t>& threadsBusy() {
+    static std::atomic<size_t> busy{0};
+    return busy;
+  }
+
+  // Занять поток, если лимит не исчерпан (текущий поток тоже считается)
+  static bool acquireThread() {
+    size_t busy = threadsBusy().load();
+    while (busy + 1 < threadLimit().load()) {
+      if (threadsBusy().compare_exchange_weak(busy, busy + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Пул рабочих потоков parallelInvoke. Потоки создаются по мере
+  // надобности (не больше, чем задач в работе) и живут до конца
+  // программы; задачи в очереди берут и они, и ждущий их вызов
+  class WorkerPool {
+   public:
+    // Задачи одного вызова parallelInvoke
+    struct Batch {
+      size_t pending = 0;
+      std::exception_ptr error;
+    };
+
+   private:
+    struct Job {
+      const std::function<void()>* task;
+      Batch* batch;
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    std::deque<Job> queue;
+    std::vector<std::thread> threads;
+    bool stopping = false;
+
+    // Выполнить задачу, исключение сохранить в пакете; поток,
+    // занятый под задачу, возвращается в бюджет
+    void run(const Job& job) {
+      std::exception_ptr error;
+      try {
+        (*job.task)();
+      } catch (...) {
+        error = std::current_exception();
+      }
+      --threadsBusy();
+      std::lock_guard<std::mutex> lock(mutex);
+      if (error && !job.batch->error) {
+        job.batch->error = error;
+      }
+      --job.batch->pending;
+      finished.notify_all();
+    }
+
+    void loop() {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (true) {
+        wake.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+          return;
+        }
+        Job job = queue.front();
+        queue.pop_front();
+        lock.unlock();
+        run(job);
+        lock.lock();
+      }
+    }
+
+   public:
+    static WorkerPool& instance() {
+      static WorkerPool pool;
+      return pool;
+    }
+
+    ~WorkerPool() {
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+      }
+      wake.notify_all();
+      for (std::thread& thread : threads) {
+        thread.join();
+      }
+    }
+
+    // Поставить задачу в очередь; false, если потоков нет и создать
+    // ни одного не удалось
+    bool post(const std::function<void()>* task, Batch& batch) {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (threads.size() < threadsBusy().load()) {
+        try {
+          threads.emplace_back([this] { loop(); });
+        } catch (const std::system_error&) {
+          if (threads.empty()) {
+            return false;
+          }
+        }
+      }
+      ++batch.pending;
+      queue.push_back({task, &batch});
+      wake.notify_one();
+      return true;
+    }
+
+    // Дождаться задач пакета; не взятые потоками выполняются здесь же
+    void wait(Batch& batch) {
+      std::unique_lock<std::mutex> lock(mutex);
+      while (batch.pending != 0) {
+        auto own = std::find_if(queue.begin(), queue.end(),
+                                [&](const Job& job) {
+                                  return job.batch == &batch;
+                                });
+        if (own == queue.end()) {
+          finished.wait(lock);
+          continue;
+        }
+        Job job = *own;
+        queue.erase(own);
+        lock.unlock();
+        run(job);
+        lock.lock();
+      }
+    }
+  };
+
+  // Выполнить независимые задачи: пока есть свободные потоки, задачи
+  // уходят в пул, остальные и последняя выполняются в текущем потоке.
+  // Возврат только после завершения всех задач (задачи ссылаются на
+  // стек вызывающего); первое исключение пробрасывается после этого
+  static void parallelInvoke(
+      std::initializer_list<std::function<void()>> tasks) {
+    WorkerPool& pool = WorkerPool::instance();
+    WorkerPool::Batch batch;
+    std::exception_ptr error;
+    for (const std::function<void()>& task : tasks) {
+      if (&task != tasks.end() - 1 && acquireThread()) {
+        if (pool.post(&task, batch)) {
+          continue;
+        }
+        --threadsBusy();
+      }
+      try {
+        task();
+      } catch (...) {
+        error = std::current_exception();
+        break;
+      }
+    }
+    pool.wait(batch);
+    if (error) {
+      std::rethrow_exception(error);
+    }
+    if (batch.error) {
+      std::rethrow_exception(batch.error);
+    }
+  }
+
+  // Умножение "в столбик", r[0..an + bn) = a * b
+  static void mulBasecase(uint64_t* r, const uint64_t* a, size_t an,
+                          const uint64_t* b, size_t bn) {
+    std::fill(r, r + an + bn, 0);
+    for (size_t j = 0; j < bn; ++j) {
+      r[an + j] = (b[j] == 0 ? 0 : addMulRow(r + j, a, an, b[j]));
+    }
+  }
+
+  // Длинный a режется на куски длины bn, r[0..an + bn) = a * b
+  static void mulUnbalanced(uint64_t* r, const uint64_t* a, size_t an,
+                            const uint64_t* b, size_t bn) {
+    std::fill(r, r + an + bn, 0);
+    ScratchArena::Frame scratch;
+    uint64_t* part = scratch.take(2 * bn);
+    for (size_t i = 0; i < an; i += bn) {
+      size_t len = std::min(bn, an - i);
+      mulLimbs(part, a + i, len, b, bn);
+      addLimbs(r + i, an + bn - i, part, len + bn);
+    }
+  }
+
+  // |a - b| для a длины n и b длины bn <= n, возвращает true, если a < b
+  static bool absDiff(uint64_t* r, const uint64_t* a, size_t n,
+                      const uint64_t* b, size_t bn) {
+    std::copy(b, b + bn, r);
+    std::fill(r + bn, r + n, 0);
+    if (cmpLimbs(a, r, n) >= 0) {
+      std::copy(a, a + n, r);
+      subLimbs(r, n, b, bn);
+      return false;
+    }
+    subLimbs(r, n, a, n);
+    return true;
+  }
+
+  // Карацуба, bn > (an + 1) / 2; r[0..an + bn) = a * b
+  static void mulKaratsuba(uint64_t* r, const uint64_t* a, size_t an,
+                           const uint64_t* b, size_t bn) {
+    size_t m = (an + 1) / 2;
+    ScratchArena::Frame scratch;
+    uint64_t* da = scratch.take(6 * m + 1);
+    uint64_t* db = da + m;
+    uint64_t* mid = db + m;
+    uint64_t* sum = mid + 2 * m;
+    bool neg = absDiff(da, a, m, a + m, an - m);
+    neg ^= absDiff(db, b, m, b + m, bn - m);
+    // z0 = a0 * b0 и z2 = a1 * b1 сразу на своих местах
+    auto low = [&] { mulLimbs(r, a, m, b, m); };
+    auto high = [&] { mulLimbs(r + 2 * m, a + m, an - m, b + m, bn - m); };
+    auto middle = [&] { mulLimbs(mid, da, m, db, m); };
+    if (bn >= PARALLEL_THRESHOLD) {
+      parallelInvoke({low, high, middle});
+    } else {
+      low();
+      high();
+      middle();
+    }
+    // (a0 - a1)(b0 - b1) = z0 + z2 - z1
+    std::copy(r, r + 2 * m, sum);
+    sum[2 * m] = addLimbs(sum, 2 * m, r + 2 * m, an + bn - 2 * m);
+    if (neg) {
+      addLimbs(sum, 2 * m + 1, mid, 2 * m);
+    } else {
+      subLimbs(sum, 2 * m + 1, mid, 2 * m);
+    }
+    addLimbs(r + m, an + bn - m, sum, std::min(2 * m + 1, an + bn - m));
+  }
+
+  // Тоом-3 (точки 0, 1, -1, -2, inf), bn > 2 * ceil(an / 3)
+  static void mulToom3(uint64_t* r, const uint64_t* a, size_t an,
+                       const uint64_t* b, size_t bn) {
+    size_t k = (an + 2) / 3;
+    BigInteger a0 = fromLimbs(a, k), a1 = fromLimbs(a + k, k);
+    BigInteger a2 = fromLimbs(a + 2 * k, an - 2 * k);
+    BigInteger b0 = fromLimbs(b, k), b1 = fromLimbs(b + k, k);
+    BigInteger b2 = fromLimbs(b + 2 * k, bn - 2 * k);
+    BigInteger pm1 = a0 + a2, qm1 = b0 + b2;
+    BigInteger p1 = pm1 + a1, q1 = qm1 + b1;
+    pm1 -= a1;
+    qm1 -= b1;
+    BigInteger pm2 = (pm1 + a2) * 2 - a0, qm2 = (qm1 + b2) * 2 - b0;
+    BigInteger r0, r1, rm1, rm2, r4;
+    if (bn >= PARALLEL_THRESHOLD) {
+      parallelInvoke({[&] { r0 = a0 * b0; }, [&] { r1 = p1 * q1; },
+                      [&] { rm1 = pm1 * qm1; }, [&] { rm2 = pm2 * qm2; },
+                      [&] { r4 = a2 * b2; }});
+    } else {
+      r0 = a0 * b0;
+      r1 = p1 * q1;
+      rm1 = pm1 * qm1;
+      rm2 = pm2 * qm2;
+      r4 = a2 * b2;
+    }
+    // Интерполяция по схеме Бодрато
+    BigInteger r3 = rm2 - r1;
+    r3.divmodSmall(3);
+    r1 -= rm1;
+    r1.divmodSmall(2);
+    BigInteger r2 = rm1 - r0;
+    r3 = r2 - r3;
+    r3.divmodSmall(2);
+    r3 += r4 * 2;
+    r2 += r1;
+    r2 -= r4;
+    r1 -= r3;
+    // Все коэффициенты неотрицательны, складываем их прямо в r
+    std::fill(r, r + an + bn, 0);
+    const BigInteger* coef[5] = {&r0, &r1, &r2, &r3, &r4};
+    for (size_t i = 0; i < 5; ++i) {
+      addLimbs(r + i * k, an + bn - i * k, coef[i]->digits.data(),
+               coef[i]->digits.size());
+    }
+  }
+
+  // Деление нормализованных лимбов (алгоритм D): старший бит v[vn - 1]
+  // равен 1, u[un - vn..un) < v, vn >= 2. Частное пишется в
+  // q[0..un - vn), остаток остаётся в u[0..vn), выше него нули
+  static void divNormalized(uint64_t* q, uint64_t* u, size_t un,
+                            const uint64_t* v, size_t vn) {
+    uint64_t top = v[vn - 1], second = v[vn - 2];
+    for (size_t j = un - vn; j > 0; --j) {
+      uint64_t* w = u + j - 1;
+      // Оценка цифры частного по двум старшим лимбам и её уточнение
+      uint128 num = (uint128(w[vn]) << 64) | w[vn - 1];
+      uint128 qhat = num / top, rhat = num % top;
+      while ((qhat >> 64) != 0 || qhat * second > ((rhat << 64) | w[vn - 2])) {
+        --qhat;
+        rhat += top;
+        if ((rhat >> 64) != 0) {
+          break;
+        }
+      }
+      // w -= qhat * v
+      uint128 cur = uint128(w[vn]) - subMulRow(w, v, vn, uint64_t(qhat));
+      w[vn] = uint64_t(cur);
+      if ((cur >> 64) != 0) {
+        --qhat;
+        w[vn] += addLimbs(w, vn, v, vn);
+      }
+      q[j - 1] = uint64_t(qhat);
+    }
+  }
+
+  // Деление модулей по Кнуту (алгоритм D): quot = |a| / |b|, rem = |a| % |b|
+  static void divmodKnuth(const uint64_t* a, size_t an, const uint64_t* b,
+                          size_t bn, BigInteger& quot, BigInteger& rem) {
+    // quot и rem пишутся поверх своей памяти: в циклах НОД они живут
+    // между вызовами
+    quot.isNegative = rem.isNegative = false;
+    if (an < bn) {
+      quot.digits.resize(0);
+      rem.digits.assign(a, a + an);
+      rem.delZero();
+      return;
+    }
+    if (bn == 1) {
+      quot.digits.assign(a, a + an);
+      rem.digits.assign(1, quot.divmodSmall(b[0]));
+      rem.delZero();
+      return;
+    }
+    // Нормализация сдвигом: старший бит делителя равен 1
+    int shift = __builtin_clzll(b[bn - 1]);
+    ScratchArena::Frame scratch;
+    uint64_t* u = scratch.take(an + 1);
+    uint64_t* v = scratch.take(bn);
+    u[an] = shiftLeftLimbs(u, a, an, shift);
+    shiftLeftLimbs(v, b, bn, shift);
+    quot.digits.resize(an - bn + 1);
+    divNormalized(quot.digits.data(), u, an + 1, v, bn);
+    quot.delZero();
+    shiftRightLimbs(u, u, bn, shift);
+    rem.digits.assign(u, u + bn);
+    rem.delZero();
+  }
+
+  // Бурникель-Циглер, 2n лимбов на n на месте: a[0..2n) < b * 2^(64n),
+  // старший бит b[n - 1] равен 1. Частное пишется в q[0..n), остаток
+  // остаётся в a[0..n), a[n..2n) обнуляется
+  static void divmod2n1n(uint64_t* q, uint64_t* a, const uint64_t* b,
+                         size_t n) {
+    if (n % 2 != 0 || n < BZ_THRESHOLD) {
+      divNormalized(q, a, 2 * n, b, n);
+      return;
+    }
+    size_t k = n / 2;
+    divmod3n2n(q + k, a + k, b, k);
+    divmod3n2n(q, a, b, k);
+  }
+
+  // Бурникель-Циглер, 3k лимбов на 2k на месте: a[0..3k) < b * 2^(64k).
+  // Частное пишется в q[0..k), остаток остаётся в a[0..2k)
+  static void divmod3n2n(uint64_t* q, uint64_t* a, const uint64_t* b,
+                         size_t k) {
+    const uint64_t* b1 = b + k;
+    if (cmpLimbs(a + 2 * k, b1, k) < 0) {
+      divmod2n1n(q, a + k, b1, k);
+    } else {
+      // Старшая треть a равна b1, частное упирается в 2^(64k) - 1:
+      // a[k..3k) - (2^(64k) - 1) * b1 = a[k..2k) + b1
+      std::fill(q, q + k, UINT64_MAX);
+      std::fill(a + 2 * k, a + 3 * k, 0);
+      addLimbs(a + k, 2 * k, b1, k);
+    }
+    // a -= q * b0; при отрицательном остатке частное уменьшается
+    size_t qn = k, b0n = k;
+    while (qn > 0 && q[qn - 1] == 0) {
+      --qn;
+    }
+    while (b0n > 0 && b[b0n - 1] == 0) {
+      --b0n;
+    }
+    uint64_t borrow = 0;
+    if (qn != 0 && b0n != 0) {
+      ScratchArena::Frame scratch;
+      uint64_t* product = scratch.take(qn + b0n);
+      mulLimbs(product, q, qn, b, b0n);
+      borrow = subLimbs(a, 3 * k, product, qn + b0n);
+    }
+    uint64_t one = 1;
+    while (borrow != 0) {
+      subLimbs(q, k, &one, 1);
+      borrow -= addLimbs(a, 3 * k, b, 2 * k);
+    }
+  }
 
-  // Удалить нули в конце
-  void delZero() {
-    int sz = digits.size() - 1;
-    while (sz >= 0 && digits[sz] == 0) {
-      digits.pop_back();
-      --sz;
+  // Деление модулей Бурникелем-Циглером: a делится поблочно по n лимбов
+  // на месте в лимбах арены
+  static void divmodBZ(const BigInteger& a, const BigInteger& b,
+                       BigInteger& quot, BigInteger& rem) {
+    // n = m * 2^j >= |b|, m < BZ_THRESHOLD: рекурсия делится пополам
+    size_t m = b.digits.size(), j = 0;
+    while (m >= BZ_THRESHOLD) {
+      m = (m + 1) / 2;
+      ++j;
     }
+    size_t an = a.digits.size(), bn = b.digits.size();
+    size_t n = m << j, sigma = n - bn;
+    int shift = __builtin_clzll(b.digits.back());
+    // Старший блок нормализованного a меньше b: его верхний лимб нулевой
+    size_t t = std::max(size_t(2), (an + sigma + 1 + n) / n);
+    ScratchArena::Frame scratch;
+    uint64_t* u = scratch.take(t * n);
+    uint64_t* v = scratch.take(n);
+    std::fill(u, u + t * n, 0);
+    std::fill(v, v + sigma, 0);
+    u[sigma + an] = shiftLeftLimbs(u + sigma, a.digits.data(), an, shift);
+    shiftLeftLimbs(v + sigma, b.digits.data(), bn, shift);
+    quot.isNegative = rem.isNegative = false;
+    quot.digits.resize((t - 1) * n);
+    for (size_t i = t - 1; i > 0; --i) {
+      divmod2n1n(quot.digits.data() + (i - 1) * n, u + (i - 1) * n, v, n);
+    }
+    quot.delZero();
+    shiftRightLimbs(u + sigma, u + sigma, bn, shift);
+    rem.digits.assign(u + sigma, u + n);
+    rem.delZero();
   }
 
-  // Привести к виду, где цифры лежат в диапазоне [0, MOD - 1]
-  void beautify() {
-    long long add = 0;
-    delZero();
-    size_t sz = digits.size();
-    for (size_t i = 0; i < sz; ++i) {
-      digits[i] += add;
-      if (digits[i] < 0) {
-        add = -1;
+  // Деление модулей, выбор алгоритма по размеру
+  static void divmodAbs(const BigInteger& a, const BigInteger& b,
+                        BigInteger& quot, BigInteger& rem) {
+    if (b.digits.size() < BZ_THRESHOLD ||
+        a.digits.size() < b.digits.size() + BZ_THRESHOLD) {
+      divmodKnuth(a.digits.data(), a.digits.size(), b.digits.data(),
+                  b.digits.size(), quot, rem);
+    } else {
+      divmodBZ(a, b, quot, rem);
+    }
+  }
+
+  // r[0..n) = r * x + carry, возвращает перенос из старшего лимба
+  static uint64_t mulSmallLimbs(uint64_t* r, size_t n, uint64_t x,
+                                uint64_t carry = 0) {
+    for (size_t i = 0; i < n; ++i) {
+      uint128 cur = uint128(r[i]) * x + carry;
+      r[i] = uint64_t(cur);
+      carry = uint64_t(cur >> 64);
+    }
+    return carry;
+  }
+
+  // x^e mod p
+  static uint64_t powMod(uint64_t x, uint64_t e, uint64_t p) {
+    uint64_t result = 1;
+    x %= p;
+    for (; e > 0; e >>= 1) {
+      if (e & 1) {
+        result = result * x % p;
+      }
+      x = x * x % p;
+    }
+    return result;
+  }
+
+  // Прямое или обратное NTT по простому модулю p = c * 2^k + 1 с корнем 3
+  template <uint32_t p>
+  static void ntt(std::vector<uint32_t>& f, bool invert) {
+    size_t n = f.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+      size_t bit = n >> 1;
+      for (; j & bit; bit >>= 1) {
+        j ^= bit;
+      }
+      j ^= bit;
+      if (i < j) {
+        std::swap(f[i], f[j]);
+      }
+    }
+    std::vector<uint32_t> roots(n / 2);
+    for (size_t len = 2; len <= n; len <<= 1) {
+      size_t half = len / 2;
+      uint64_t w = powMod(3, (p - 1) / len, p);
+      if (invert) {
+        w = powMod(w, p - 2, p);
+      }
+      roots[0] = 1;
+      for (size_t j = 1; j < half; ++j) {
+        roots[j] = uint32_t(roots[j - 1] * w % p);
+      }
+      for (size_t i = 0; i < n; i += len) {
+        for (size_t j = 0; j < half; ++j) {
+          uint32_t u = f[i + j];
+          uint32_t v = uint32_t(uint64_t(f[i + j + half]) * roots[j] % p);
+          f[i + j] = (u + v >= p ? u + v - p : u + v);
+          f[i + j + half] = (u >= v ? u - v : u + p - v);
+        }
+      }
+    }
+    if (invert) {
+      uint64_t inv_n = powMod(n, p - 2, p);
+      for (size_t i = 0; i < n; ++i) {
+        f[i] = uint32_t(f[i] * inv_n % p);
+      }
+    }
+  }
+
+  // Свёртка a и b, разбитых на 32-битные половины лимбов, по модулю p;
+  // n - длина преобразования (степень двойки)
+  template <uint32_t p>
+  static std::vector<uint32_t> convolutionMod(const uint64_t* a, size_t an,
+                                              const uint64_t* b, size_t bn,
+                                              size_t n) {
+    std::vector<uint32_t> fa(n, 0);
+    for (size_t i = 0; i < an; ++i) {
+      fa[2 * i] = uint32_t(a[i]) % p;
+      fa[2 * i + 1] = uint32_t(a[i] >> 32) % p;
+    }
+    ntt<p>(fa, false);
+    if (a == b && an == bn) {
+      for (size_t i = 0; i < n; ++i) {
+        fa[i] = uint32_t(uint64_t(fa[i]) * fa[i] % p);
+      }
+    } else {
+      std::vector<uint32_t> fb(n, 0);
+      for (size_t i = 0; i < bn; ++i) {
+        fb[2 * i] = uint32_t(b[i]) % p;
+        fb[2 * i + 1] = uint32_t(b[i] >> 32) % p;
+      }
+      ntt<p>(fb, false);
+      for (size_t i = 0; i < n; ++i) {
+        fa[i] = uint32_t(uint64_t(fa[i]) * fb[i] % p);
+      }
+    }
+    ntt<p>(fa, true);
+    return fa;
+  }
+
+  // Умножение через NTT по трём простым с восстановлением по КТО,
+  // an + bn <= NTT_MAX_LENGTH; r[0..an + bn) = a * b
+  static void mulNTT(uint64_t* r, const uint64_t* a, size_t an,
+                     const uint64_t* b, size_t bn) {
+    const uint32_t p1 = 469762049, p2 = 167772161, p3 = 998244353;
+    size_t len = 2 * (an + bn) - 1, n = 1;
+    while (n < len) {
+      n <<= 1;
+    }
+    std::vector<uint32_t> r1, r2, r3;
+    parallelInvoke({[&] { r1 = convolutionMod<p1>(a, an, b, bn, n); },
+                    [&] { r2 = convolutionMod<p2>(a, an, b, bn, n); },
+                    [&] { r3 = convolutionMod<p3>(a, an, b, bn, n); }});
+    const uint64_t inv_p1 = powMod(p1, p2 - 2, p2);
+    const uint64_t p1p2 = uint64_t(p1) * p2;
+    const uint64_t inv_p1p2 = powMod(p1p2 % p3, p3 - 2, p3);
+    // Коэффициенты свёртки меньше (an + bn) * 2^64 < p1 * p2 * p3
+    uint128 carry = 0;
+    for (size_t i = 0; i < len + 1; ++i) {
+      if (i < len) {
+        uint64_t x1 = r1[i];
+        uint64_t t2 = (r2[i] + p2 - x1 % p2) % p2 * inv_p1 % p2;
+        uint64_t x12 = x1 + p1 * t2;
+        uint64_t t3 = (r3[i] + p3 - x12 % p3) % p3 * inv_p1p2 % p3;
+        carry += x12 + uint128(p1p2) * t3;
+      }
+      uint64_t half = uint32_t(carry);
+      carry >>= 32;
+      if (i % 2 == 0) {
+        r[i / 2] = half;
       } else {
-        add = digits[i] / MOD;
+        r[i / 2] |= half << 32;
       }
-      digits[i] = (digits[i] + MOD) % MOD;
     }
-    while (add != 0) {
-      digits.push_back(add);
-      add = digits[sz] / MOD;
-      digits[sz] %= MOD;
-      ++sz;
+  }
+
+  // r[0..an + bn) = a * b, выбор алгоритма по размеру
+  static void mulLimbs(uint64_t* r, const uint64_t* a, size_t an,
+                       const uint64_t* b, size_t bn) {
+    if (an < bn) {
+      std::swap(a, b);
+      std::swap(an, bn);
     }
-    delZero();
-    if (digits.size() == 0) {
-      isNegative = false;
+    if (bn < KARATSUBA_THRESHOLD) {
+      mulBasecase(r, a, an, b, bn);
+    } else if (bn >= NTT_THRESHOLD && an + bn <= NTT_MAX_LENGTH) {
+      mulNTT(r, a, an, b, bn);
+    } else if (bn <= (an + 1) / 2) {
+      mulUnbalanced(r, a, an, b, bn);
+    } else if (bn >= TOOM3_THRESHOLD && bn > 2 * ((an + 2) / 3)) {
+      mulToom3(r, a, an, b, bn);
+    } else {
+      mulKaratsuba(r, a, an, b, bn);
     }
   }
 
-  // <= по модулю
-  bool absLessEq(const BigInteger& other) {
-    if (digits.size() != other.digits.size()) {
-      return digits.size() < other.digits.size();
+  // DEC_MOD^(2^i); степени считаются один раз и кэшируются
+  static const BigInteger& decPower(size_t i) {
+    static std::deque<BigInteger> powers;
+    static std::mutex powers_mutex;
+    std::lock_guard<std::mutex> lock(powers_mutex);
+    if (powers.size() == 0) {
+      powers.push_back(BigInteger());
+      powers.back().digits.push_back(DEC_MOD);
     }
-    for (int i = int(digits.size() - 1); i >= 0; --i) {
-      if (digits[i] != other.digits[i]) {
-        return digits[i] < other.digits[i];
+    while (powers.size() <= i) {
+      powers.push_back(powers.back() * powers.back());
+    }
+    return powers[i];
+  }
+
+  // 10^e как произведение кэшированных DEC_MOD^(2^i)
+  static BigInteger powerOfTen(size_t e) {
+    BigInteger result = 1;
+    for (size_t i = 0; i < e % POW; ++i) {
+      result.digits[0] *= BASE;
+    }
+    for (size_t q = e / POW, i = 0; q != 0; q >>= 1, ++i) {
+      if (q & 1) {
+        result *= decPower(i);
       }
     }
-    return true;
+    return result;
   }
 
-  // < по модулю
-  bool absLess(const BigInteger& other, int index = 0) {
-    if (digits.size() == 0) {
-      return true;
+  // Наибольшее i с 2^i < n, n >= 2
+  static size_t splitLevel(size_t n) {
+    size_t i = 0;
+    while ((size_t(2) << i) < n) {
+      ++i;
+    }
+    return i;
+  }
+
+  // Число из десятичных блоков c[0..n), младшие первыми
+  static BigInteger fromDecChunks(const uint64_t* c, size_t n) {
+    BigInteger result;
+    if (n <= RADIX_THRESHOLD) {
+      for (size_t i = n; i > 0; --i) {
+        uint64_t carry = mulSmallLimbs(result.digits.data(),
+                                       result.digits.size(), DEC_MOD, c[i - 1]);
+        if (carry != 0) {
+          result.digits.push_back(carry);
+        }
+      }
+      result.beautify();
+      return result;
+    }
+    size_t low = size_t(1) << splitLevel(n);
+    result = fromDecChunks(c + low, n - low);
+    result *= decPower(splitLevel(n));
+    result += fromDecChunks(c, low);
+    return result;
+  }
+
+  // Десятичные блоки |x| в out[0..n), младшие первыми; |x| < DEC_MOD^n,
+  // out заполнен нулями
+  static void toDecChunks(const BigInteger& x, uint64_t* out, size_t n) {
+    if (n <= RADIX_THRESHOLD) {
+      // |x| < DEC_MOD^n < 2^(64n): хватает n лимбов на стеке
+      uint64_t rest[RADIX_THRESHOLD];
+      size_t len = x.digits.size();
+      std::copy(x.digits.begin(), x.digits.end(), rest);
+      for (size_t i = 0; len != 0; ++i) {
+        out[i] = divSmallLimbs(rest, len, DEC_MOD);
+        while (len != 0 && rest[len - 1] == 0) {
+          --len;
+        }
+      }
+      return;
     }
-    int start = digits.size() - 1;
-    while (digits[start] == 0 && start - 1 >= 0) {
-      --start;
+    size_t low = size_t(1) << splitLevel(n);
+    BigInteger quot, rem;
+    divmodAbs(x, decPower(splitLevel(n)), quot, rem);
+    toDecChunks(rem, out, low);
+    toDecChunks(quot, out + low, n - low);
+  }
+
+  // Число десятичных блоков, которых заведомо хватит для |x|
+  size_t decChunkBound() const {
+    return bitLength() * 30103 / 100000 / POW + 1;
+  }
+
+  // floor(bits * lg 2), точно для любого 64-битного bits: константа -
+  // floor(lg 2 * 2^128), округлённая вниз, и ошибка меньше 2^-64, а
+  // ближе к целому bits * lg 2 не подходит (проверено по подходящим
+  // дробям lg 2)
+  static constexpr size_t floorLog10Pow2(size_t bits) {
+    uint64_t constexpr LG2_HIGH = 0x4d104d427de7fbccULL;
+    uint64_t constexpr LG2_LOW = 0x47c4acd605be48bcULL;
+    uint128 low = uint128(bits) * LG2_LOW >> 64;
+    return size_t((uint128(bits) * LG2_HIGH + low) >> 64);
+  }
+
+  // Старшие 64 бита ненулевого модуля со старшим битом, равным 1:
+  // |x| ~ topWord() * 2^(bitLength() - 64), остаток отброшен
+  uint64_t topWord() const {
+    size_t n = digits.size();
+    int shift = __builtin_clzll(digits[n - 1]);
+    uint64_t top = digits[n - 1] << shift;
+    if (shift != 0 && n > 1) {
+      top |= digits[n - 2] >> (64 - shift);
     }
-    if (start + 1 - index != int(other.digits.size())) {
-      return start + 1 - index < int(other.digits.size());
+    return top;
+  }
+
+  // Число цифр в value, value > 0
+  static size_t countDigits(uint64_t value) {
+    size_t len = 0;
+    for (; value != 0; value /= BASE) {
+      ++len;
     }
-    int j = other.digits.size() - 1;
-    for (int i = start; i >= index; --i) {
-      if (digits[i] != other.digits[j]) {
-        return digits[i] < other.digits[j];
+    return len;
+  }
+
+  // Ровно width младших цифр value (с ведущими нулями) в p
+  static char* writeDigits(char* p, uint64_t value, size_t width) {
+    static const char pairs[] =
+        "00010203040506070809101112131415161718192021222324"
+        "25262728293031323334353637383940414243444546474849"
+        "50515253545556575859606162636465666768697071727374"
+        "75767778798081828384858687888990919293949596979899";
+    char* q = p + width;
+    // Группы по 9 цифр печатаются в 32-битной арифметике
+    while (q > p) {
+      size_t group_len = std::min(size_t(q - p), size_t(9));
+      uint32_t group = uint32_t(value % 1000000000);
+      value /= 1000000000;
+      for (; group_len >= 2; group_len -= 2) {
+        q -= 2;
+        std::memcpy(q, pairs + 2 * (group % 100), 2);
+        group /= 100;
+      }
+      if (group_len == 1) {
+        *--q = char('0' + group);
       }
-      --j;
     }
-    return false;
+    return p + width;
   }
 
-  // Увеличить модуль на 1
-  void increaseAbs() {
-    for (int i = 0; i < int(digits.size()); ++i) {
-      if (digits[i] == BASE - 1) {
-        digits[i] = 0;
-      } else {
-        ++digits[i];
-        break;
+  // r[0..n) = x * p - y * q; разность неотрицательна и помещается в n лимбов
+  static void mulSubPair(uint64_t* r, const uint64_t* x, uint64_t p,
+                         const uint64_t* y, uint64_t q, size_t n) {
+    uint64_t carry_x = 0, carry_y = 0, borrow = 0;
+    for (size_t i = 0; i < n; ++i) {
+      uint128 u = uint128(x[i]) * p + carry_x;
+      uint128 v = uint128(y[i]) * q + carry_y;
+      carry_x = uint64_t(u >> 64);
+      carry_y = uint64_t(v >> 64);
+      uint64_t low_u = uint64_t(u), low_v = uint64_t(v);
+      uint64_t diff = low_u - low_v;
+      uint64_t next = (low_u < low_v ? 1 : 0) + (diff < borrow ? 1 : 0);
+      r[i] = diff - borrow;
+      borrow = next;
+    }
+  }
+
+  // Бинарный НОД одного лимба, a и b ненулевые
+  static uint64_t gcdWord(uint64_t a, uint64_t b) {
+    int common = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    while (b != 0) {
+      b >>= __builtin_ctzll(b);
+      if (a > b) {
+        std::swap(a, b);
       }
+      b -= a;
     }
+    return a << common;
   }
 
-  // Уменьшить модуль на 1
-  void decreaseAbs() {
-    for (int i = 0; i < int(digits.size()); ++i) {
-      if (digits[i] == 0) {
-        digits[i] = BASE - 1;
+  // Бинарный НОД двух лимбов, a и b ненулевые
+  static uint128 gcdDoubleWord(uint128 a, uint128 b) {
+    auto zeros = [](uint128 x) {
+      uint64_t low = uint64_t(x);
+      return low != 0 ? __builtin_ctzll(low)
+                      : 64 + __builtin_ctzll(uint64_t(x >> 64));
+    };
+    int common = zeros(a | b);
+    a >>= zeros(a);
+    while (b != 0) {
+      b >>= zeros(b);
+      if ((a >> 64) == 0 && (b >> 64) == 0) {
+        return uint128(gcdWord(uint64_t(a), uint64_t(b))) << common;
+      }
+      if (a > b) {
+        std::swap(a, b);
+      }
+      b -= a;
+    }
+    return a << common;
+  }
+
+  // НОД модулей по Лемеру: пока числа длинные, шаги Евклида ведутся по
+  // старшим 62 битам с однословными кофакторами, и только затем
+  // применяются к полным числам одной линейной комбинацией. Остаток
+  // длиной до GCD_BINARY_THRESHOLD лимбов добивается бинарным НОД
+  static BigInteger gcdAbs(BigInteger a, BigInteger b) {
+    a.isNegative = false;
+    b.isNegative = false;
+    if (!b.absLessEq(a)) {
+      std::swap(a, b);
+    }
+    LimbVector next_a, next_b;
+    BigInteger quot, rem;
+    while (b.digits.size() > GCD_BINARY_THRESHOLD) {
+      size_t n = a.digits.size();
+      b.digits.resize(n);
+      int shift = __builtin_clzll(a.digits[n - 1]);
+      auto leading = [&](const BigInteger& x) {
+        uint128 top = (uint128(x.digits[n - 1]) << 64) | x.digits[n - 2];
+        return int64_t((top << shift) >> 66);
+      };
+      int64_t x = leading(a), y = leading(b);
+      int64_t A = 1, B = 0, C = 0, D = 1;
+      while (y + C != 0 && y + D != 0) {
+        int64_t q = (x + A) / (y + C);
+        if (q != (x + B) / (y + D)) {
+          break;
+        }
+        int64_t t = A - q * C;
+        A = C;
+        C = t;
+        t = B - q * D;
+        B = D;
+        D = t;
+        t = x - q * y;
+        x = y;
+        y = t;
+      }
+      if (B == 0) {
+        // Старших битов не хватило: один полный шаг Евклида
+        b.delZero();
+        divmodAbs(a, b, quot, rem);
+        a.digits.swap(b.digits);
+        b.digits.swap(rem.digits);
+        continue;
+      }
+      // В каждой паре кофакторов (A, B) и (C, D) знаки противоположны
+      next_a.resize(n);
+      next_b.resize(n);
+      const uint64_t* pa = a.digits.data();
+      const uint64_t* pb = b.digits.data();
+      if (B < 0) {
+        mulSubPair(next_a.data(), pa, A, pb, -B, n);
       } else {
-        --digits[i];
-        break;
+        mulSubPair(next_a.data(), pb, B, pa, -A, n);
+      }
+      if (D < 0) {
+        mulSubPair(next_b.data(), pa, C, pb, -D, n);
+      } else {
+        mulSubPair(next_b.data(), pb, D, pa, -C, n);
       }
+      a.digits.swap(next_a);
+      b.digits.swap(next_b);
+      a.delZero();
+      b.delZero();
     }
+    if (b.digits.size() == 0) {
+      return a;
+    }
+    if (a.digits.size() > b.digits.size()) {
+      divmodAbs(a, b, quot, rem);
+      a.digits.swap(rem.digits);
+      if (a.digits.size() == 0) {
+        return b;
+      }
+    }
+    auto value = [](const BigInteger& x) {
+      uint128 high = (x.digits.size() > 1 ? x.digits[1] : 0);
+      return (high << 64) | x.digits[0];
+    };
+    uint128 result = gcdDoubleWord(value(a), value(b));
+    a.digits.assign(1, uint64_t(result));
+    a.digits.push_back(uint64_t(result >> 64));
+    a.delZero();
+    return a;
   }
 
-  // Добавить цифру в конец
-  void addDigit(char digit) {
-    digits[digits.size() - 1] *= BASE;
-    digits[digits.size() - 1] += digit;
+  // Простые до n включительно (решето по нечётным)
+  static std::vector<uint64_t> primesUpTo(uint64_t n) {
+    std::vector<uint64_t> primes;
+    if (n < 2) {
+      return primes;
+    }
+    primes.push_back(2);
+    // composite[i] отвечает числу 2i + 1
+    std::vector<bool> composite((n + 1) / 2);
+    for (uint64_t i = 1; i < composite.size(); ++i) {
+      if (composite[i]) {
+        continue;
+      }
+      uint64_t p = 2 * i + 1;
+      primes.push_back(p);
+      for (uint64_t j = p * p / 2; j < composite.size(); j += p) {
+        composite[j] = true;
+      }
+    }
+    return primes;
   }
 
- public:
-  BigInteger() : digits({}), isNegative(false) {}
-  BigInteger(long long x) : digits({}), isNegative(x < 0) {
-    if (x < 0) {
-      x *= -1;
+  // Произведение машинных слов: слова сливаются в лимбы, лимбы в листы
+  // до PRODUCT_LEAF лимбов умножением на короткое, листы - деревом
+  static BigInteger productOfWords(const std::vector<uint64_t>& words) {
+    std::vector<BigInteger> leaves;
+    BigInteger leaf = 1;
+    uint64_t limb = 1;
+    auto flush = [&] {
+      if (leaf.digits.size() >= PRODUCT_LEAF) {
+        leaves.push_back(std::move(leaf));
+        leaf = 1;
+      }
+      leaf.mulSmall(limb);
+      limb = 1;
+    };
+    for (uint64_t word : words) {
+      uint64_t next;
+      if (__builtin_mul_overflow(limb, word, &next)) {
+        flush();
+        next = word;
+      }
+      limb = next;
     }
-    while (x > 0) {
-      digits.push_back(x % MOD);
-      x /= MOD;
+    flush();
+    leaves.push_back(std::move(leaf));
+    return product(leaves);
+  }
+
+  // Нечётная часть swing(n) = n! / (floor(n / 2)!)^2: показатель
+  // простого p равен числу нечётных floor(n / p^i)
+  static BigInteger oddSwing(uint64_t n, const std::vector<uint64_t>& primes) {
+    std::vector<uint64_t> words;
+    for (size_t i = 1; i < primes.size() && primes[i] <= n; ++i) {
+      for (uint64_t q = n / primes[i]; q != 0; q /= primes[i]) {
+        if (q % 2 != 0) {
+          words.push_back(primes[i]);
+        }
+      }
     }
+    return productOfWords(words);
   }
 
-  BigInteger(const std::string str)
-      : digits({}), isNegative(str.size() > 0 && str[0] == '-') {
-    int len = str.size();
-    if (len == 0) {
-      return;
+  // Нечётная часть n! по Люшни: oddFactorial(n / 2)^2 * oddSwing(n)
+  static BigInteger oddFactorial(uint64_t n,
+                                 const std::vector<uint64_t>& primes) {
+    if (n < 3) {
+      return 1;
     }
-    int board = 0;
-    if (isNegative) board = 1;
-    for (int i = len - POW; i >= board; i -= POW) {
-      digits.push_back(0);
-      for (int j = i; j < i + POW; ++j) {
-        addDigit(str[j] - '0');
+    BigInteger half = oddFactorial(n / 2, primes);
+    return half * half * oddSwing(n, primes);
+  }
+
+  // |x|^e возведением в квадрат
+  static BigInteger powAbs(const BigInteger& x, uint64_t e) {
+    BigInteger result = 1, base = x;
+    base.isNegative = false;
+    for (; e != 0; e >>= 1) {
+      if (e % 2 != 0) {
+        result *= base;
+      }
+      if (e > 1) {
+        base *= base;
       }
     }
-    if ((len - isNegative) % POW != 0) {
-      digits.push_back(0);
-      for (int j = board; j < (len - isNegative) % POW + isNegative; ++j) {
-        addDigit(str[j] - '0');
+    return result;
+  }
+
+  // r^k > v без переполнения
+  static bool powExceeds(uint64_t r, uint64_t k, uint64_t v) {
+    uint128 power = 1;
+    for (uint64_t i = 0; i < k; ++i) {
+      power *= r;
+      if (power > v) {
+        return true;
       }
     }
+    return false;
   }
 
-  explicit operator bool() const { return !(digits.size() == 0); }
+  // floor(|n|^(1/k)) для k >= 2. Корень из старших битов, сдвинутый на
+  // место, оценивает ответ сверху с половиной верных битов, и спуск
+  // Ньютона x -> ((k - 1) x + n / x^(k - 1)) / k доводит его до точного
+  static BigInteger rootAbs(const BigInteger& n, uint64_t k) {
+    size_t bits = n.bitLength();
+    if (bits == 0) {
+      return BigInteger();
+    }
+    if (bits <= k) {
+      return 1;
+    }
+    if (bits <= 64) {
+      uint64_t v = n.digits[0];
+      auto r = uint64_t(std::pow(double(v), 1.0 / double(k)));
+      while (r > 1 && powExceeds(r, k, v)) {
+        --r;
+      }
+      while (!powExceeds(r + 1, k, v)) {
+        ++r;
+      }
+      return BigInteger(static_cast<long long>(r));
+    }
+    // n = m * 2^(kt) + младшие биты, корень из m содержит около t битов
+    size_t t = bits / k / 2;
+    BigInteger x = 1;
+    if (t == 0) {
+      // Корень меньше 4, сверху его оценивает 2^ceil(bits / k)
+      x.shiftLeft((bits + k - 1) / k);
+    } else {
+      BigInteger m = n;
+      m.isNegative = false;
+      m.shiftRight(k * t);
+      x = rootAbs(m, k) + 1;
+      x.shiftLeft(t);
+    }
+    while (true) {
+      BigInteger y = divmod(n, powAbs(x, k - 1)).first;
+      y.isNegative = false;
+      y += x * static_cast<long long>(k - 1);
+      y.divmodSmall(k);
+      if (!(y < x)) {
+        return x;
+      }
+      x = std::move(y);
+    }
+  }
 
-  BigInteger& operator=(long long x) {
-    *this = BigInteger(x);
-    return *this;
+  // Бит r установлен, если r - квадратичный вычет по модулю m
+  static constexpr uint128 squareResidues(uint64_t m) {
+    uint128 mask = 0;
+    for (uint64_t x = 0; x < m; ++x) {
+      mask |= uint128(1) << (x * x % m);
+    }
+    return mask;
   }
 
-  BigInteger& operator+=(const BigInteger& other) {
-    int my_sz = digits.size();
-    int other_sz = other.digits.size();
-    if (other_sz > my_sz) {
-      digits.resize(other_sz);
-      my_sz = other_sz;
+  // this += other или this -= other (negate = true) без копии other
+  BigInteger& addSigned(const BigInteger& other, bool negate) {
+    size_t my_sz = digits.size();
+    size_t other_sz = other.digits.size();
+    bool other_negative = (other.isNegative != negate);
+    if (other_sz == 1 && (my_sz == 0 || isNegative == other_negative)) {
+      addSmall(other.digits[0]);
+      isNegative = other_negative;
+      return *this;
     }
-    if (isNegative == other.isNegative) {
-      for (int i = 0; i < std::min(my_sz, other_sz); ++i) {
-        digits[i] += other.digits[i];
+    if (isNegative == other_negative) {
+      if (other_sz > my_sz) {
+        digits.resize(other_sz);
       }
+      uint64_t carry = addLimbs(digits.data(), digits.size(),
+                                other.digits.data(), other_sz);
+      if (carry != 0) {
+        digits.push_back(carry);
+      }
+    } else if (absLessEq(other)) {
+      LimbVector res = other.digits;
+      subLimbs(res.data(), other_sz, digits.data(), my_sz);
+      digits.swap(res);
+      isNegative = other_negative;
     } else {
-      if (absLessEq(other)) {
-        isNegative = other.isNegative;
-        for (int i = 0; i < std::min(my_sz, other_sz); ++i) {
-          digits[i] = other.digits[i] - digits[i];
-        }
+      subLimbs(digits.data(), my_sz, other.digits.data(), other_sz);
+    }
+    beautify();
+    return *this;
+  }
+
+
+  // this += a * b (negate = false) или this -= a * b без временного
+  // произведения, пока множители малы
+  void addProduct(const BigInteger& a, const BigInteger& b, bool negate) {
+    if (a.digits.size() == 0 || b.digits.size() == 0) {
+      return;
+    }
+    bool product_negative = ((a.isNegative != b.isNegative) != negate);
+    const BigInteger* x = &a;
+    const BigInteger* y = &b;
+    if (x->digits.size() < y->digits.size()) {
+      std::swap(x, y);
+    }
+    size_t an = x->digits.size(), bn = y->digits.size();
+    bool same_sign = (digits.size() == 0 || isNegative == product_negative);
+    // Строки произведения накапливаются прямо в лимбах this, если модуль
+    // не может сменить знак и this не совпадает с множителем
+    bool in_place = (this != x && this != y && bn < KARATSUBA_THRESHOLD &&
+                     (same_sign || digits.size() > an + bn));
+    if (!in_place) {
+      BigInteger product;
+      product.digits.resize(an + bn);
+      mulLimbs(product.digits.data(), x->digits.data(), an, y->digits.data(),
+               bn);
+      product.isNegative = product_negative;
+      product.beautify();
+      addSigned(product, false);
+      return;
+    }
+    if (digits.size() == 0) {
+      isNegative = product_negative;
+    }
+    size_t n = std::max(digits.size(), an + bn) + 1;
+    digits.resize(n);
+    uint64_t* r = digits.data();
+    for (size_t j = 0; j < bn; ++j) {
+      uint64_t high;
+      if (same_sign) {
+        high = addMulRow(r + j, x->digits.data(), an, y->digits[j]);
+        addLimbs(r + j + an, n - j - an, &high, 1);
       } else {
-        for (int i = 0; i < std::min(my_sz, other_sz); ++i) {
-          digits[i] -= other.digits[i];
-        }
+        high = subMulRow(r + j, x->digits.data(), an, y->digits[j]);
+        subLimbs(r + j + an, n - j - an, &high, 1);
+      }
+    }
+    beautify();
+  }
+
+ public:
+  BigInteger() : digits(), isNegative(false) {}
+  BigInteger(const BigInteger& other) = default;
+  BigInteger(BigInteger&& other) noexcept
+      : digits(std::move(other.digits)), isNegative(other.isNegative) {
+    other.isNegative = false;
+  }
+  BigInteger(long long x) : digits(), isNegative(x < 0) {
+    uint64_t abs = (x < 0 ? 0 - uint64_t(x) : uint64_t(x));
+    if (abs != 0) {
+      digits.push_back(abs);
+    }
+  }
+
+  BigInteger(const std::string str)
+      : digits(), isNegative(str.size() > 0 && str[0] == '-') {
+    // Блоки по POW цифр справа налево, затем рекурсивная сборка
+    size_t start = (isNegative ? 1 : 0);
+    std::vector<uint64_t> chunks;
+    for (size_t end = str.size(); end > start;) {
+      size_t begin = (end - start > size_t(POW) ? end - POW : start);
+      uint64_t chunk = 0;
+      for (size_t j = begin; j < end; ++j) {
+        chunk = chunk * BASE + (str[j] - '0');
       }
+      chunks.push_back(chunk);
+      end = begin;
     }
+    digits = fromDecChunks(chunks.data(), chunks.size()).digits;
     beautify();
+  }
+
+  explicit operator bool() const { return !(digits.size() == 0); }
+
+  BigInteger& operator=(const BigInteger& other) = default;
+
+  BigInteger& operator=(BigInteger&& other) noexcept {
+    digits = std::move(other.digits);
+    isNegative = other.isNegative;
+    other.isNegative = false;
+    return *this;
+  }
+
+  BigInteger& operator=(long long x) {
+    *this = BigInteger(x);
     return *this;
   }
 
+  BigInteger& operator+=(const BigInteger& other) {
+    return addSigned(other, false);
+  }
+
   BigInteger& operator++() {
     digits.push_back(0);
     if (isNegative) {
@@ -205,7 +1975,7 @@ class BigInteger {
     } else {
       increaseAbs();
     }
-    delZero();
+    beautify();
     return *this;
   }
 
@@ -221,20 +1991,21 @@ class BigInteger {
   }
 
   BigInteger& operator-=(const BigInteger& other) {
-    BigInteger copy = other;
-    copy.isNegative = !copy.isNegative;
-    *this += copy;
-    return *this;
+    return addSigned(other, true);
   }
 
   BigInteger& operator--() {
+    if (digits.size() == 0) {
+      *this = -1;
+      return *this;
+    }
     digits.push_back(0);
     if (isNegative) {
       increaseAbs();
     } else {
       decreaseAbs();
     }
-    delZero();
+    beautify();
     return *this;
   }
 
@@ -245,85 +2016,248 @@ class BigInteger {
   }
 
   BigInteger& operator*=(const BigInteger& other) {
-    BigInteger res;
-    if (other == 1_bi) {
+    if (digits.size() == 0 || other.digits.size() == 0) {
+      *this = 0;
       return *this;
     }
-    if (other == -1_bi) {
-      isNegative = !isNegative;
+    bool negative = (isNegative != other.isNegative);
+    if (other.digits.size() == 1) {
+      mulSmall(other.digits[0]);
+      isNegative = negative;
       return *this;
     }
-    res.isNegative = (isNegative != other.isNegative);
-    res.digits.assign(digits.size() + other.digits.size(), 0);
-    for (int j = 0; j < int(other.digits.size()); ++j) {
-      for (int i = 0; i < int(digits.size()); ++i) {
-        res.digits[i + j] += digits[i] * other.digits[j];
-        if (i + j < int(res.digits.size()) - 1) {
-          res.digits[i + j + 1] += res.digits[i + j] / MOD;
-          res.digits[i + j] %= MOD;
-        }
-      }
+    if (digits.size() == 1) {
+      uint64_t x = digits[0];
+      digits = other.digits;
+      mulSmall(x);
+      isNegative = negative;
+      return *this;
     }
+    BigInteger res;
+    res.isNegative = negative;
+    res.digits.resize(digits.size() + other.digits.size());
+    mulLimbs(res.digits.data(), digits.data(), digits.size(),
+             other.digits.data(), other.digits.size());
     res.beautify();
-    *this = res;
+    *this = std::move(res);
     return *this;
   }
 
-  BigInteger& operator/=(BigInteger other) {
-    BigInteger add = 0_bi, ans = 0_bi;
-    ans.isNegative = (isNegative != other.isNegative);
-    other.isNegative = false;
-    for (int i = digits.size(); i > 0; --i) {
-      add *= MOD;
-      add += digits[i - 1];
-      if (add < other) {
-        ans.digits.push_back(0);
-        continue;
-      }
-      int l = 0, r = MOD;
-      while (r - l > 1) {
-        int mid = (l + r) / 2;
-        if (other * mid <= add) {
-          l = mid;
-        } else {
-          r = mid;
-        }
+  BigInteger& operator/=(const BigInteger& other) {
+    if (other.digits.size() == 1) {
+      bool negative = (isNegative != other.isNegative);
+      divmodSmall(other.digits[0]);
+      isNegative = negative && digits.size() != 0;
+      return *this;
+    }
+    BigInteger quot, rem;
+    divmodAbs(*this, other, quot, rem);
+    quot.isNegative = (isNegative != other.isNegative);
+    quot.isNegative &= (quot.digits.size() != 0);
+    *this = std::move(quot);
+    return *this;
+  }
+
+  BigInteger& operator%=(const BigInteger& other) {
+    if (other.digits.size() == 1) {
+      uint64_t rem = modSmallLimbs(digits.data(), digits.size(),
+                                   other.digits[0]);
+      digits.assign(1, rem);
+      beautify();
+      return *this;
+    }
+    *this = std::move(divmod(*this, other).second);
+    return *this;
+  }
+
+  // Знак: -1, 0 или 1
+  int sign() const {
+    if (digits.size() == 0) {
+      return 0;
+    }
+    return isNegative ? -1 : 1;
+  }
+
+  // Число потоков для умножения (и деления через него) длинных чисел;
+  // 0 - по числу ядер. По умолчанию 1, то есть без потоков
+  static void setThreadCount(size_t count) {
+    if (count == 0) {
+      count = std::max(1u, std::thread::hardware_concurrency());
+    }
+    threadLimit().store(count);
+  }
+
+  static size_t getThreadCount() { return threadLimit().load(); }
+
+  // Число значащих битов модуля (0 для нуля)
+  size_t bitLength() const {
+    if (digits.size() == 0) {
+      return 0;
+    }
+    return 64 * digits.size() - __builtin_clzll(digits.back());
+  }
+
+  // Точная длина десятичной записи вместе со знаком
+  size_t decimalSize() const {
+    if (digits.size() == 0) {
+      return 1;
+    }
+    if (digits.size() == 1) {
+      return isNegative + countDigits(digits[0]);
+    }
+    // 2^(bits - 1) <= |x| < 2^bits, поэтому цифр len или len - 1;
+    // сравнение с 10^(len - 1) нужно, только если границы различны.
+    // Без точного floorLog10Pow2 длина здесь завышалась бы на 1
+    static_assert(floorLog10Pow2(12539179) == 3774668);
+    static_assert(floorLog10Pow2(18646195) == 5613063);
+    static_assert(floorLog10Pow2(24753211) == 7451458);
+    static_assert(floorLog10Pow2(SIZE_MAX) == 5553023288523357131ULL);
+    size_t bits = bitLength();
+    size_t len = floorLog10Pow2(bits) + 1;
+    if (floorLog10Pow2(bits - 1) + 1 != len &&
+        !powerOfTen(len - 1).absLessEq(*this)) {
+      --len;
+    }
+    return isNegative + len;
+  }
+
+  // Запись в [first, last) без выделения памяти для чисел до
+  // RADIX_THRESHOLD лимбов; возвращает конец записи или nullptr,
+  // если буфер мал
+  char* toChars(char* first, char* last) const {
+    if (digits.size() == 0) {
+      if (first == last) {
+        return nullptr;
       }
-      ans.digits.push_back(l);
-      add -= other * l;
+      *first = '0';
+      return first + 1;
+    }
+    // Заведомо малый буфер отвергается до перевода: цифр не меньше
+    // floor((bits - 1) lg 2) + 1
+    size_t min_len = isNegative + floorLog10Pow2(bitLength() - 1) + 1;
+    if (size_t(last - first) < min_len) {
+      return nullptr;
+    }
+    size_t n = decChunkBound();
+    uint64_t local[RADIX_THRESHOLD] = {};
+    std::vector<uint64_t> heap;
+    uint64_t* chunks = local;
+    if (n > RADIX_THRESHOLD) {
+      heap.assign(n, 0);
+      chunks = heap.data();
+    }
+    toDecChunks(*this, chunks, n);
+    while (n > 1 && chunks[n - 1] == 0) {
+      --n;
+    }
+    size_t top_len = countDigits(chunks[n - 1]);
+    if (size_t(last - first) < isNegative + top_len + (n - 1) * POW) {
+      return nullptr;
+    }
+    if (isNegative) {
+      *first++ = '-';
+    }
+    first = writeDigits(first, chunks[n - 1], top_len);
+    for (size_t i = n - 1; i > 0; --i) {
+      first = writeDigits(first, chunks[i - 1], POW);
+    }
+    return first;
+  }
+
+  // Запись в out, возвращает число записанных символов (0, если out мал)
+  size_t toChars(std::span<char> out) const {
+    char* end = toChars(out.data(), out.data() + out.size());
+    return end == nullptr ? 0 : end - out.data();
+  }
+
+  std::string toString() const {
+    std::string str(digits.size() == 0 ? 1 : decChunkBound() * POW + 1, '0');
+    str.resize(toChars(str.data(), str.data() + str.size()) - str.data());
+    return str;
+  }
+
+  // Двоичный формат: заголовок SERIAL_HEADER байт (версия, знак, число
+  // лимбов) и лимбы little-endian, младшие первыми. Без перевода в
+  // десятичную систему и ровно 8 байт на лимб
+  size_t serializedSize() const { return SERIAL_HEADER + 8 * digits.size(); }
+
+  // Запись в out, возвращает число записанных байт (0, если out мал)
+  size_t serialize(std::span<std::byte> out) const {
+    if (out.size() < serializedSize() || digits.size() > UINT32_MAX) {
+      return 0;
     }
-    std::reverse(ans.digits.begin(), ans.digits.end());
-    *this = ans;
-    beautify();
-    return *this;
+    writeHeader(out.data());
+    storeLimbs(out.data() + SERIAL_HEADER, digits.data(), digits.size());
+    return serializedSize();
   }
 
-  BigInteger& operator%=(BigInteger other) {
-    BigInteger temp = *this;
-    temp /= other;
-    temp *= other;
-    *this -= temp;
-    return *this;
+  // Запись в out; при слишком длинном числе ставится failbit
+  std::ostream& serialize(std::ostream& out) const {
+    if (digits.size() > UINT32_MAX) {
+      out.setstate(std::ios::failbit);
+      return out;
+    }
+    std::byte header[SERIAL_HEADER];
+    writeHeader(header);
+    out.write(reinterpret_cast<const char*>(header), SERIAL_HEADER);
+    std::byte block[8 * SERIAL_BLOCK];
+    for (size_t done = 0; done < digits.size(); done += SERIAL_BLOCK) {
+      size_t len = std::min(digits.size() - done, SERIAL_BLOCK);
+      storeLimbs(block, digits.data() + done, len);
+      out.write(reinterpret_cast<const char*>(block), 8 * len);
+    }
+    return out;
   }
 
-  std::string toString() const {
-    std::string str;
-    if (digits.size() == 0) {
-      return "0";
+  // Чтение из in, возвращает число прочитанных байт (0, если запись
+  // обрезана или некорректна; x тогда не меняется)
+  static size_t deserialize(std::span<const std::byte> in, BigInteger& x) {
+    bool negative;
+    size_t count;
+    if (in.size() < SERIAL_HEADER ||
+        !readHeader(in.data(), negative, count) ||
+        (in.size() - SERIAL_HEADER) / 8 < count) {
+      return 0;
     }
-    if (isNegative) {
-      str.push_back('-');
+    const std::byte* limbs = in.data() + SERIAL_HEADER;
+    if (count != 0 && loadWord(limbs + 8 * (count - 1)) == 0) {
+      return 0;
     }
-    for (int i = int(digits.size()) - 1; i >= 0; --i) {
-      std::string add = std::to_string(digits[i]);
-      if (i != int(digits.size()) - 1) {
-        for (int j = 0; j < POW - int(add.size()); ++j) {
-          str.push_back('0');
-        }
+    x.digits.resize(count);
+    loadLimbs(x.digits.data(), limbs, count);
+    x.isNegative = negative;
+    return SERIAL_HEADER + 8 * count;
+  }
+
+  // При ошибке выставляет failbit, x не меняется
+  static std::istream& deserialize(std::istream& in, BigInteger& x) {
+    std::byte header[SERIAL_HEADER];
+    bool negative;
+    size_t count;
+    if (!in.read(reinterpret_cast<char*>(header), SERIAL_HEADER) ||
+        !readHeader(header, negative, count)) {
+      in.setstate(std::ios::failbit);
+      return in;
+    }
+    // Блоками: обрезанный поток не заставит выделить память под
+    // заявленную в заголовке длину
+    BigInteger result;
+    std::byte block[8 * SERIAL_BLOCK];
+    for (size_t done = 0; done < count; done += SERIAL_BLOCK) {
+      size_t len = std::min(count - done, SERIAL_BLOCK);
+      if (!in.read(reinterpret_cast<char*>(block), 8 * len)) {
+        return in;
       }
-      str += add;
+      result.digits.resize(done + len);
+      loadLimbs(result.digits.data() + done, block, len);
     }
-    return str;
+    if (count != 0 && result.digits.back() == 0) {
+      in.setstate(std::ios::failbit);
+      return in;
+    }
+    result.isNegative = negative;
+    x = std::move(result);
+    return in;
   }
 };
 
@@ -333,30 +2267,249 @@ BigInteger operator+(const BigInteger& a, const BigInteger& b) {
   return result;
 }
 
+// Временные операнды отдают свои лимбы результату
+BigInteger operator+(BigInteger&& a, const BigInteger& b) {
+  a += b;
+  return std::move(a);
+}
+
+BigInteger operator+(const BigInteger& a, BigInteger&& b) {
+  b += a;
+  return std::move(b);
+}
+
+BigInteger operator+(BigInteger&& a, BigInteger&& b) {
+  a += b;
+  return std::move(a);
+}
+
 BigInteger operator-(const BigInteger& a, const BigInteger& b) {
   BigInteger result = a;
   result -= b;
   return result;
 }
 
+BigInteger operator-(BigInteger&& a, const BigInteger& b) {
+  a -= b;
+  return std::move(a);
+}
+
 BigInteger operator*(const BigInteger& a, const BigInteger& b) {
   BigInteger result = a;
   result *= b;
   return result;
 }
 
+BigInteger operator*(BigInteger&& a, const BigInteger& b) {
+  a *= b;
+  return std::move(a);
+}
+
+BigInteger operator*(const BigInteger& a, BigInteger&& b) {
+  b *= a;
+  return std::move(b);
+}
+
+BigInteger operator*(BigInteger&& a, BigInteger&& b) {
+  a *= b;
+  return std::move(a);
+}
+
 BigInteger operator/(const BigInteger& a, const BigInteger& b) {
   BigInteger result = a;
   result /= b;
   return result;
 }
 
+BigInteger operator/(BigInteger&& a, const BigInteger& b) {
+  a /= b;
+  return std::move(a);
+}
+
 BigInteger operator%(const BigInteger& a, const BigInteger& b) {
   BigInteger result = a;
   result %= b;
   return result;
 }
 
+BigInteger operator%(BigInteger&& a, const BigInteger& b) {
+  a %= b;
+  return std::move(a);
+}
+
+// {a / b, a % b} за одно деление; остаток имеет знак делимого
+std::pair<BigInteger, BigInteger> divmod(const BigInteger& a,
+                                         const BigInteger& b) {
+  std::pair<BigInteger, BigInteger> result;
+  BigInteger& quot = result.first;
+  BigInteger& rem = result.second;
+  if (b.digits.size() == 1) {
+    quot = a;
+    uint64_t small = quot.divmodSmall(b.digits[0]);
+    rem.digits.assign(1, small);
+    rem.delZero();
+  } else {
+    BigInteger::divmodAbs(a, b, quot, rem);
+  }
+  quot.isNegative = (a.isNegative != b.isNegative && quot.digits.size() != 0);
+  rem.isNegative = (a.isNegative && rem.digits.size() != 0);
+  return result;
+}
+
+// НОД модулей a и b (неотрицателен, gcd(0, 0) = 0)
+BigInteger gcd(BigInteger a, BigInteger b) {
+  return BigInteger::gcdAbs(std::move(a), std::move(b));
+}
+
+// Произведение [first, last) сбалансированным деревом: множители на
+// каждом уровне одного порядка длины, так что работают быстрые
+// умножения. Пустое произведение равно 1
+template <typename It>
+BigInteger product(It first, It last) {
+  std::vector<BigInteger> level(first, last);
+  if (level.size() == 0) {
+    return 1;
+  }
+  while (level.size() > 1) {
+    size_t half = level.size() / 2;
+    for (size_t i = 0; i < half; ++i) {
+      level[i] = std::move(level[2 * i]) * level[2 * i + 1];
+    }
+    if (level.size() % 2 != 0) {
+      level[half] = std::move(level.back());
+    }
+    level.resize(level.size() - half);
+  }
+  return std::move(level[0]);
+}
+
+template <typename Range>
+BigInteger product(const Range& range) {
+  return product(std::begin(range), std::end(range));
+}
+
+// n! = oddFactorial(n) * 2^(n - popcount(n))
+BigInteger factorial(uint64_t n) {
+  BigInteger result =
+      BigInteger::oddFactorial(n, BigInteger::primesUpTo(n));
+  result.shiftLeft(n - __builtin_popcountll(n));
+  return result;
+}
+
+// C(n, k); 0 при k > n
+BigInteger binomial(uint64_t n, uint64_t k) {
+  if (k > n) {
+    return BigInteger();
+  }
+  k = std::min(k, n - k);
+  std::vector<uint64_t> words;
+  if (k < n / BigInteger::BINOMIAL_SIEVE_RATIO) {
+    // Короткое произведение n (n - 1) ... (n - k + 1), делённое на k!
+    for (uint64_t i = 0; i < k; ++i) {
+      words.push_back(n - i);
+    }
+    BigInteger falling = BigInteger::productOfWords(words);
+    return std::move(divmod(falling, factorial(k)).first);
+  }
+  // Показатель p по Куммеру - число заёмов при вычитании k из n по
+  // основанию p
+  std::vector<uint64_t> primes = BigInteger::primesUpTo(n);
+  for (uint64_t p : primes) {
+    uint64_t borrow = 0;
+    for (uint64_t x = n, y = k; x != 0; x /= p, y /= p) {
+      borrow = (x % p < y % p + borrow ? 1 : 0);
+      if (borrow != 0) {
+        words.push_back(p);
+      }
+    }
+  }
+  return BigInteger::productOfWords(words);
+}
+
+// Произведение простых, не превосходящих n
+BigInteger primorial(uint64_t n) {
+  return BigInteger::productOfWords(BigInteger::primesUpTo(n));
+}
+
+// floor(sqrt(n)) для n >= 0: ньютоновские шаги с удвоением точности,
+// на каждом одно деление вдвое более длинных чисел, чем на предыдущем
+BigInteger isqrt(const BigInteger& n) {
+  if (n.digits.size() == 0) {
+    return BigInteger();
+  }
+  size_t c = (n.bitLength() - 1) / 2;
+  BigInteger a = 1;
+  size_t d = 0;
+  for (int s = 63 - __builtin_clzll(c | 1); s >= 0; --s) {
+    size_t e = d;
+    d = c >> s;
+    if (d == 0) {
+      continue;
+    }
+    BigInteger top = n;
+    top.isNegative = false;
+    top.shiftRight(2 * c - e - d + 1);
+    BigInteger quot = std::move(divmod(top, a).first);
+    a.shiftLeft(d - e - 1);
+    a += quot;
+  }
+  if (!(a * a).absLessEq(n)) {
+    --a;
+  }
+  return a;
+}
+
+// Корень k-й степени (k >= 1) с округлением к нулю; для отрицательного
+// n степень k должна быть нечётной
+BigInteger iroot(const BigInteger& n, uint64_t k) {
+  if (k == 1) {
+    return n;
+  }
+  BigInteger result = (k == 2 ? isqrt(n) : BigInteger::rootAbs(n, k));
+  result.isNegative = n.isNegative && result.digits.size() != 0;
+  return result;
+}
+
+// Проверка на точный квадрат. Вычеты по модулям 64, 63, 65 и 11
+// отсекают почти все не-квадраты без извлечения корня
+bool isPerfectSquare(const BigInteger& n) {
+  if (n.isNegative) {
+    return false;
+  }
+  if (n.digits.size() == 0) {
+    return true;
+  }
+  static constexpr BigInteger::uint128 mod64 =
+      BigInteger::squareResidues(64);
+  static constexpr BigInteger::uint128 mod63 =
+      BigInteger::squareResidues(63);
+  static constexpr BigInteger::uint128 mod65 =
+      BigInteger::squareResidues(65);
+  static constexpr BigInteger::uint128 mod11 =
+      BigInteger::squareResidues(11);
+  if (((mod64 >> (n.digits[0] % 64)) & 1) == 0) {
+    return false;
+  }
+  uint64_t r = BigInteger::modSmallLimbs(n.digits.data(), n.digits.size(),
+                                         63 * 65 * 11);
+  if (((mod63 >> (r % 63)) & 1) == 0 || ((mod65 >> (r % 65)) & 1) == 0 ||
+      ((mod11 >> (r % 11)) & 1) == 0) {
+    return false;
+  }
+  BigInteger root = isqrt(n);
+  return root * root == n;
+}
+
+// acc += a * b
+void addmul(BigInteger& acc, const BigInteger& a, const BigInteger& b) {
+  acc.addProduct(a, b, false);
+}
+
+// acc -= a * b
+void submul(BigInteger& acc, const BigInteger& a, const BigInteger& b) {
+  acc.addProduct(a, b, true);
+}
+
 bool operator<(const BigInteger& a, const BigInteger& b) {
   if (a.isNegative && !b.isNegative) {
     return true;
@@ -411,26 +2564,15 @@ bool operator==(const BigInteger& a, const BigInteger& b) {
 bool operator!=(const BigInteger& a, const BigInteger& b) { return !(a == b); }
 
 std::ostream& operator<<(std::ostream& out, const BigInteger& bi) {
-  if (bi.isNegative) {
-    out << '-';
-  }
-  for (int i = bi.digits.size() - 1; i >= 0; --i) {
-    if (bi.digits[i] == 0) {
-      for (int j = 0; j < bi.POW; ++j) {
-        out << 0;
-      }
-      continue;
-    }
-    if (i != int(bi.digits.size()) - 1) {
-      std::string out_str = std::to_string(bi.digits[i]);
-      for (int j = 0; j < bi.POW - int(out_str.size()); ++j) {
-        out << 0;
-      }
-    }
-    out << bi.digits[i];
-  }
-  if (bi.digits.size() == 0) {
-    out << 0;
+  // Верхняя оценка длины выбирает буфер заранее, перевод ровно один
+  size_t bound = bi.decChunkBound() * BigInteger::POW + 1;
+  char local[256];
+  if (bound <= sizeof(local)) {
+    out.write(local, bi.toChars(local, local + bound) - local);
+  } else {
+    std::string str(bound, '0');
+    out.write(str.data(), bi.toChars(str.data(), str.data() + bound) -
+                              str.data());
   }
   return out;
 }
@@ -452,38 +2594,482 @@ BigInteger operator""_bi(const char* number, size_t) {
   return result;
 }
 
+// Число в формате BigInteger::serialize, читаемое прямо из чужого
+// буфера (например, отображённого в память файла) без копирования и
+// без требований к выравниванию. Буфер должен жить дольше вида
+class BigIntegerView {
+ private:
+  const std::byte* limbs = nullptr;
+  size_t count = 0;
+  bool negative = false;
+
+ public:
+  BigIntegerView() = default;
+
+  // Разбор записи из in, возвращает её длину в байтах (0, если запись
+  // обрезана или некорректна; view тогда не меняется)
+  static size_t deserialize(std::span<const std::byte> in,
+                            BigIntegerView& view) {
+    bool negative;
+    size_t count;
+    if (in.size() < BigInteger::SERIAL_HEADER ||
+        !BigInteger::readHeader(in.data(), negative, count) ||
+        (in.size() - BigInteger::SERIAL_HEADER) / 8 < count) {
+      return 0;
+    }
+    const std::byte* limbs = in.data() + BigInteger::SERIAL_HEADER;
+    if (count != 0 && BigInteger::loadWord(limbs + 8 * (count - 1)) == 0) {
+      return 0;
+    }
+    view.limbs = limbs;
+    view.count = count;
+    view.negative = negative;
+    return BigInteger::SERIAL_HEADER + 8 * count;
+  }
+
+  // Число лимбов
+  size_t size() const { return count; }
+
+  // i-й лимб, младшие первыми
+  uint64_t limb(size_t i) const {
+    return BigInteger::loadWord(limbs + 8 * i);
+  }
+
+  // Знак: -1, 0 или 1
+  int sign() const {
+    if (count == 0) {
+      return 0;
+    }
+    return negative ? -1 : 1;
+  }
+
+  // Число значащих битов модуля (0 для нуля)
+  size_t bitLength() const {
+    if (count == 0) {
+      return 0;
+    }
+    return 64 * count - __builtin_clzll(limb(count - 1));
+  }
+
+  // Копия в BigInteger
+  BigInteger toBigInteger() const {
+    BigInteger result;
+    result.digits.resize(count);
+    BigInteger::loadLimbs(result.digits.data(), limbs, count);
+    result.isNegative = negative;
+    return result;
+  }
+};
+
+// Умножение и возведение в степень по фиксированному нечётному модулю
+// в форме Монтгомери: x хранится как x * R mod m, R = 2^(64n), где n -
+// число лимбов модуля, и редукция обходится без делений
+class MontgomeryContext {
+ private:
+  using uint128 = BigInteger::uint128;
+
+  size_t n;
+  std::vector<uint64_t> modulus;
+  // -m^(-1) mod 2^64
+  uint64_t inverse;
+  // R^2 mod m и R mod m (единица в форме Монтгомери)
+  std::vector<uint64_t> rSquared;
+  std::vector<uint64_t> one;
+
+  // Лимбы x, дополненные нулями до n
+  std::vector<uint64_t> toLimbs(const BigInteger& x) const {
+    std::vector<uint64_t> result(n, 0);
+    std::copy(x.digits.data(), x.digits.data() + x.digits.size(),
+              result.begin());
+    return result;
+  }
+
+  // x mod m в [0, m); деление только для x вне этого отрезка
+  BigInteger reduceInput(const BigInteger& x) const {
+    BigInteger m = BigInteger::fromLimbs(modulus.data(), n);
+    if (x.sign() >= 0 && x < m) {
+      return x;
+    }
+    BigInteger result = x % m;
+    if (result.sign() < 0) {
+      result += m;
+    }
+    return result;
+  }
+
+  // r = t * R^(-1) mod m для t < m * R; t занимает 2n + 1 лимбов и
+  // портится
+  void redc(uint64_t* r, uint64_t* t) const {
+    t[2 * n] = 0;
+    for (size_t i = 0; i < n; ++i) {
+      uint64_t u = t[i] * inverse;
+      uint64_t carry = BigInteger::addMulRow(t + i, modulus.data(), n, u);
+      for (size_t j = i + n; carry != 0; ++j) {
+        t[j] += carry;
+        carry = (t[j] < carry ? 1 : 0);
+      }
+    }
+    uint64_t* high = t + n;
+    if (high[n] != 0 ||
+        BigInteger::cmpLimbs(high, modulus.data(), n) >= 0) {
+      BigInteger::subLimbs(high, n + 1, modulus.data(), n);
+    }
+    std::copy(high, high + n, r);
+  }
+
+  // r = a * b * R^(-1) mod m; scratch на 2n + 1 лимбов, r может
+  // совпадать с a или b
+  void montMul(uint64_t* r, const uint64_t* a, const uint64_t* b,
+               uint64_t* scratch) const {
+    BigInteger::mulLimbs(scratch, a, n, b, n);
+    redc(r, scratch);
+  }
+
+  BigInteger fromMontgomery(const std::vector<uint64_t>& x,
+                            uint64_t* scratch) const {
+    std::copy(x.begin(), x.end(), scratch);
+    std::fill(scratch + n, scratch + 2 * n, 0);
+    std::vector<uint64_t> result(n);
+    redc(result.data(), scratch);
+    return BigInteger::fromLimbs(result.data(), n);
+  }
+
+ public:
+  // Модуль m должен быть нечётным и положительным
+  explicit MontgomeryContext(const BigInteger& m)
+      : n(m.digits.size()), modulus(toLimbs(m)), inverse(0) {
+    // Обратный к m[0] по модулю 2^64 методом Ньютона: каждая итерация
+    // удваивает число верных битов, начиная с трёх
+    uint64_t inv = modulus[0];
+    for (int i = 0; i < 5; ++i) {
+      inv *= 2 - modulus[0] * inv;
+    }
+    inverse = 0 - inv;
+    BigInteger r = 1;
+    r.shiftLimbs(n);
+    one = toLimbs(r % m);
+    r.shiftLimbs(n);
+    rSquared = toLimbs(r % m);
+  }
+
+  BigInteger getModulus() const {
+    return BigInteger::fromLimbs(modulus.data(), n);
+  }
+
+  // a * b mod m
+  BigInteger mulmod(const BigInteger& a, const BigInteger& b) const {
+    std::vector<uint64_t> x = toLimbs(reduceInput(a));
+    std::vector<uint64_t> y = toLimbs(reduceInput(b));
+    std::vector<uint64_t> scratch(2 * n + 1);
+    // (a * b * R^(-1)) * R^2 * R^(-1) = a * b
+    montMul(x.data(), x.data(), y.data(), scratch.data());
+    montMul(x.data(), x.data(), rSquared.data(), scratch.data());
+    return BigInteger::fromLimbs(x.data(), n);
+  }
+
+  // base^exponent mod m скользящим окном, exponent >= 0
+  BigInteger powmod(const BigInteger& base, const BigInteger& exponent) const {
+    std::vector<uint64_t> scratch(2 * n + 1);
+    size_t bits = exponent.bitLength();
+    if (bits == 0) {
+      return fromMontgomery(one, scratch.data());
+    }
+    // Ширина окна растёт с длиной показателя
+    int window = 1;
+    while (window < 6 && bits > (size_t(1) << (2 * window + 1))) {
+      ++window;
+    }
+    // table[i] = base^(2i + 1) в форме Монтгомери
+    std::vector<std::vector<uint64_t>> table(size_t(1) << (window - 1));
+    table[0] = toLimbs(reduceInput(base));
+    montMul(table[0].data(), table[0].data(), rSquared.data(),
+            scratch.data());
+    std::vector<uint64_t> square(n);
+    montMul(square.data(), table[0].data(), table[0].data(), scratch.data());
+    for (size_t i = 1; i < table.size(); ++i) {
+      table[i].resize(n);
+      montMul(table[i].data(), table[i - 1].data(), square.data(),
+              scratch.data());
+    }
+    auto bit = [&](size_t i) {
+      return (exponent.digits[i / 64] >> (i % 64)) & 1;
+    };
+    std::vector<uint64_t> result = one;
+    for (size_t i = bits; i > 0;) {
+      if (bit(i - 1) == 0) {
+        montMul(result.data(), result.data(), result.data(), scratch.data());
+        --i;
+        continue;
+      }
+      // Самое длинное окно не длиннее window, кончающееся единицей
+      size_t low = (i >= size_t(window) ? i - window : 0);
+      while (bit(low) == 0) {
+        ++low;
+      }
+      size_t value = 0;
+      for (size_t j = i; j > low; --j) {
+        montMul(result.data(), result.data(), result.data(), scratch.data());
+        value = (value << 1) | bit(j - 1);
+      }
+      montMul(result.data(), result.data(), table[value >> 1].data(),
+              scratch.data());
+      i = low;
+    }
+    return fromMontgomery(result, scratch.data());
+  }
+};
+
+// Редукция Барретта по фиксированному модулю (любой чётности): обратное
+// mu = floor(2^(128n) / m) считается один раз, а остаток от x < m^2
+// получается двумя умножениями и вычитанием
+class BarrettReducer {
+ private:
+  BigInteger modulus;
+  BigInteger mu;
+  // 2^(64(n + 1)), где n - число лимбов модуля
+  BigInteger wrap;
+  size_t n;
+
+ public:
+  // Модуль m должен быть положительным
+  explicit BarrettReducer(const BigInteger& m)
+      : modulus(m), n(m.digits.size()) {
+    BigInteger power = 1;
+    power.shiftLimbs(2 * n);
+    mu = power / modulus;
+    wrap = 1;
+    wrap.shiftLimbs(n + 1);
+  }
+
+  const BigInteger& getModulus() const { return modulus; }
+
+  // x mod m в [0, m); вне отрезка [0, m^2) обычное деление
+  BigInteger reduce(const BigInteger& x) const {
+    if (x.sign() < 0 || x.digits.size() > 2 * n) {
+      BigInteger result = x % modulus;
+      if (result.sign() < 0) {
+        result += modulus;
+      }
+      return result;
+    }
+    if (x < modulus) {
+      return x;
+    }
+    // q = floor(floor(x / b^(n - 1)) * mu / b^(n + 1)) меньше частного
+    // x / m не больше чем на 2 (b = 2^64)
+    const uint64_t* px = x.digits.data();
+    size_t q1_len = x.digits.size() - (n - 1);
+    size_t mu_len = mu.digits.size();
+    std::vector<uint64_t> buffer(q1_len + mu_len + 2 * (n + 1));
+    uint64_t* product = buffer.data();
+    BigInteger::mulLimbs(product, px + n - 1, q1_len, mu.digits.data(),
+                         mu_len);
+    const uint64_t* q = product + n + 1;
+    size_t q_len = q1_len + mu_len - (n + 1);
+    // Нужны только младшие n + 1 лимбов q * m
+    uint64_t* low = product + q1_len + mu_len;
+    std::fill(low, low + n + 1, 0);
+    const uint64_t* pm = modulus.digits.data();
+    for (size_t i = 0; i < q_len && i < n + 1; ++i) {
+      size_t len = std::min(n, n + 1 - i);
+      uint64_t carry = BigInteger::addMulRow(low + i, pm, len, q[i]);
+      if (i + len < n + 1) {
+        low[i + len] += carry;
+      }
+    }
+    // r = (x - q * m) mod b^(n + 1), заём за старший лимб отбрасывается
+    uint64_t* r = low + n + 1;
+    std::copy(px, px + std::min(x.digits.size(), n + 1), r);
+    std::fill(r + std::min(x.digits.size(), n + 1), r + n + 1, 0);
+    BigInteger::subLimbs(r, n + 1, low, n + 1);
+    while (r[n] != 0 || BigInteger::cmpLimbs(r, pm, n) >= 0) {
+      BigInteger::subLimbs(r, n + 1, pm, n);
+    }
+    return BigInteger::fromLimbs(r, n);
+  }
+
+  // a * b mod m
+  BigInteger mulmod(const BigInteger& a, const BigInteger& b) const {
+    return reduce(reduce(a) * reduce(b));
+  }
+};
+
 class Rational {
   bool friend operator<(const Rational& a, const Rational& b);
   bool friend operator==(const Rational& a, const Rational& b);
+  Rational friend operator+(const Rational& a, Rational&& b);
+  Rational friend operator*(const Rational& a, Rational&& b);
 
  private:
   BigInteger Up;
   BigInteger Down;
+  // Ленивый режим: дробь сокращается, только когда её длина в битах
+  // выросла вдвое с прошлого сокращения (но не раньше LAZY_MIN_BITS),
+  // а также перед выводом. Знаменатель всегда положителен, поэтому
+  // сравнения перекрёстным умножением верны и без сокращения
+  bool lazy = false;
+  size_t reducedBits = 0;
+  size_t static constexpr LAZY_MIN_BITS = 1024;
+
+  using uint128 = BigInteger::uint128;
+
+  // привести к несократимой дроби
+  void beautify() {
+    BigInteger common = gcd(Up, Down);
+    if (common != 1_bi) {
+      Up /= common;
+      Down /= common;
+    }
+    reducedBits = Up.bitLength() + Down.bitLength();
+    if (Up == 0_bi) {
+      Down = 1;
+      return;
+    }
+    if (Down < 0_bi) {
+      Down *= -1;
+      Up *= -1;
+    }
+  }
+
+  // Дробь из прочитанных числителя и знаменателя; false, если
+  // знаменатель не положителен или ноль записан не как 0/1. Несократимость
+  // не проверяется: НОД сделал бы чтение квадратичным. Несокращённая
+  // запись читается как есть, сравнения с ней верны, а reduce() её
+  // сокращает
+  bool assignParts(BigInteger& up, BigInteger& down) {
+    if (down.sign() <= 0 || (up.sign() == 0 && down != 1_bi)) {
+      return false;
+    }
+    Up = std::move(up);
+    Down = std::move(down);
+    reducedBits = Up.bitLength() + Down.bitLength();
+    return true;
+  }
+
+  // Трёхстороннее сравнение a и b. Перекрёстные произведения считаются,
+  // только если ответ не ясен по знакам, длинам произведений в битах и
+  // их приближению в double
+  static int compare(const Rational& a, const Rational& b) {
+    int sign_a = a.Up.sign(), sign_b = b.Up.sign();
+    if (sign_a != sign_b) {
+      return sign_a < sign_b ? -1 : 1;
+    }
+    if (sign_a == 0) {
+      return 0;
+    }
+    // |a.Up * b.Down| лежит в [2^(bits_x - 2), 2^bits_x), так же и для y
+    int64_t up_a = a.Up.bitLength(), down_b = b.Down.bitLength();
+    int64_t down_a = a.Down.bitLength(), up_b = b.Up.bitLength();
+    int64_t bits_x = up_a + down_b, bits_y = down_a + up_b;
+    if (bits_x + 2 <= bits_y) {
+      return -sign_a;
+    }
+    if (bits_y + 2 <= bits_x) {
+      return sign_a;
+    }
+    // Старшие слова дают произведения с относительной ошибкой < 2^-50
+    double x = double(a.Up.topWord()) * double(b.Down.topWord());
+    double y = double(a.Down.topWord()) * double(b.Up.topWord());
+    x = std::ldexp(x, int(bits_x - bits_y));
+    if (x < y * (1 - 0x1p-48)) {
+      return -sign_a;
+    }
+    if (x > y * (1 + 0x1p-48)) {
+      return sign_a;
+    }
+    BigInteger cross_x = a.Up * b.Down;
+    BigInteger cross_y = a.Down * b.Up;
+    if (cross_x == cross_y) {
+      return 0;
+    }
+    return cross_x < cross_y ? -1 : 1;
+  }
+
+  // q / 2^drop с округлением к ближайшему, при равенстве к чётному;
+  // sticky: у q есть ненулевая дробная часть
+  static uint64_t roundShift(uint64_t q, int drop, bool sticky) {
+    uint64_t mantissa = q >> drop;
+    uint64_t low = q & ((uint64_t(1) << drop) - 1);
+    uint64_t half = uint64_t(1) << (drop - 1);
+    if (low > half || (low == half && (sticky || (mantissa & 1) != 0))) {
+      ++mantissa;
+    }
+    return mantissa;
+  }
+
+  // Модуль x, умноженный на 2^k
+  static BigInteger shiftedAbs(const BigInteger& x, size_t k) {
+    BigInteger result = x;
+    result.isNegative = false;
+    result.shiftLimbs(k / 64);
+    result.shiftLeftBits(int(k % 64));
+    return result;
+  }
 
-  // НОД
-  BigInteger GCD(const BigInteger& a, const BigInteger& b) {
-    if (a == 0_bi) {
-      if (b < 0_bi) {
-        return b * -1;
+  // Ближайший к Up / Down double. Обычно хватает частного старших слов,
+  // точное деление нужно только вблизи середины между соседними double
+  double toDouble() const {
+    int sign = Up.sign();
+    if (sign == 0) {
+      return 0.0;
+    }
+    int64_t shift = int64_t(Up.bitLength()) - int64_t(Down.bitLength());
+    if (shift > 1025) {
+      return sign * HUGE_VAL;
+    }
+    if (shift < -1080) {
+      return sign * 0.0;
+    }
+    if (shift > -1000 && shift < 1000) {
+      // Истинное частное, сдвинутое как q, лежит в (q - 4, q + 3)
+      uint128 q = (uint128(Up.topWord()) << 64) / Down.topWord();
+      int drop = ((q >> 64) != 0 ? 12 : 11);
+      uint64_t low = uint64_t(q) & ((uint64_t(1) << drop) - 1);
+      uint64_t half = uint64_t(1) << (drop - 1);
+      if (low + 3 <= half || low >= half + 4) {
+        uint64_t mantissa = uint64_t(q >> drop) + (low > half ? 1 : 0);
+        return sign * std::ldexp(double(mantissa), int(shift - 64 + drop));
       }
-      return b;
     }
-    return GCD(b % a, a);
+    // q = floor(|Up| * 2^k / Down) из 56-57 битов и признак остатка
+    int64_t k = 56 - shift;
+    BigInteger num = (k >= 0 ? shiftedAbs(Up, k) : shiftedAbs(Up, 0));
+    BigInteger den = (k >= 0 ? Down : shiftedAbs(Down, -k));
+    auto [quot, rem] = divmod(num, den);
+    uint64_t q = quot.digits[0];
+    int bits = 64 - __builtin_clzll(q);
+    int64_t lead = bits - 1 - k;
+    int64_t drop = bits - 53;
+    if (lead < -1022) {
+      drop += -1022 - lead;
+    }
+    if (drop >= 58) {
+      return sign * 0.0;
+    }
+    uint64_t mantissa = roundShift(q, int(drop), rem.sign() != 0);
+    return sign * std::ldexp(double(mantissa), int(drop - k));
   }
 
-  // привести к несократимой дроби
-  void beautify() {
-    BigInteger gcd = GCD(Up, Down);
-    Up /= gcd;
-    Down /= gcd;
+  // После арифметики: сразу сократить или, в ленивом режиме, только
+  // поправить знак и сократить при превышении порога
+  void normalize() {
+    if (!lazy) {
+      beautify();
+      return;
+    }
     if (Up == 0_bi) {
       Down = 1;
+      reducedBits = 0;
       return;
     }
     if (Down < 0_bi) {
       Down *= -1;
       Up *= -1;
     }
+    size_t bits = Up.bitLength() + Down.bitLength();
+    if (bits > std::max(LAZY_MIN_BITS, 2 * reducedBits)) {
+      beautify();
+    }
   }
 
  public:
@@ -491,33 +3077,46 @@ class Rational {
   Rational(const BigInteger& bi) : Up(bi), Down(1){};
   Rational(long long x) : Up(x), Down(1){};
 
+  // Включить или выключить ленивое сокращение; при выключении дробь
+  // сразу приводится к несократимой. Результат a + b, a * b и прочих
+  // бинарных операций наследует режим левого операнда a
+  void setLazy(bool on) {
+    lazy = on;
+    if (!lazy) {
+      beautify();
+    }
+  }
+
+  // Сократить дробь сейчас
+  void reduce() { beautify(); }
+
   Rational& operator+=(const Rational& other) {
     Up *= other.Down;
-    Up += other.Up * Down;
+    addmul(Up, other.Up, Down);
     Down *= other.Down;
-    beautify();
+    normalize();
     return *this;
   }
 
   Rational& operator-=(const Rational& other) {
     Up *= other.Down;
-    Up -= other.Up * Down;
+    submul(Up, other.Up, Down);
     Down *= other.Down;
-    beautify();
+    normalize();
     return *this;
   }
 
   Rational& operator/=(const Rational& other) {
     Up *= other.Down;
     Down *= other.Up;
-    beautify();
+    normalize();
     return *this;
   }
 
   Rational& operator*=(const Rational& other) {
     Up *= other.Up;
     Down *= other.Down;
-    beautify();
+    normalize();
     return *this;
   }
 
@@ -528,6 +3127,9 @@ class Rational {
   }
 
   std::string toString() {
+    if (lazy) {
+      beautify();
+    }
     std::string ans = Up.toString();
     if (Down != 1_bi) {
       ans.push_back('/');
@@ -540,34 +3142,92 @@ class Rational {
     if (precision == 0) {
       return toString();
     }
-    BigInteger ten(1);
-    for (size_t i = 1; i <= precision; ++i) {
-      ten *= 10_bi;
+    if (lazy) {
+      beautify();
+    }
+    // Все цифры ответа дает одно деление |Up| * 10^precision / Down;
+    // 10^precision собирается из кэшированных степеней
+    BigInteger scaled = Up;
+    scaled.isNegative = false;
+    scaled *= BigInteger::powerOfTen(precision);
+    BigInteger quot = divmod(scaled, Down).first;
+    size_t len = quot.decimalSize();
+    bool negative = (Up.sign() < 0 && quot.sign() != 0);
+    size_t whole_len = (len > precision ? len - precision : 1);
+    std::string ans(negative + whole_len + 1 + precision, '0');
+    char* p = ans.data();
+    if (negative) {
+      *p++ = '-';
+    }
+    if (len > precision) {
+      // Цифры пишутся подряд, затем дробная часть сдвигается за точку
+      quot.toChars(p, p + len);
+      std::memmove(p + whole_len + 1, p + whole_len, precision);
+    } else {
+      quot.toChars(ans.data() + ans.size() - len, ans.data() + ans.size());
+    }
+    p[whole_len] = '.';
+    return ans;
+  }
+
+  explicit operator double() {
+    if (lazy) {
+      beautify();
+    }
+    return toDouble();
+  }
+
+  // Двоичный формат: числитель и знаменатель подряд в формате
+  // BigInteger::serialize. Ленивая дробь перед записью сокращается
+  size_t serializedSize() {
+    if (lazy) {
+      beautify();
     }
-    BigInteger div = (Up * ten / Down);
-    std::string temp = div.toString();
-    std::string ans;
-    if (temp[0] == '-') {
-      ans += '-';
-      temp = temp.substr(1, temp.size());
+    return Up.serializedSize() + Down.serializedSize();
+  }
+
+  // Запись в out, возвращает число записанных байт (0, если out мал)
+  size_t serialize(std::span<std::byte> out) {
+    if (out.size() < serializedSize()) {
+      return 0;
     }
-    if (precision >= temp.size()) {
-      ans += '0';
-      ans += '.';
+    size_t written = Up.serialize(out);
+    size_t rest = written ? Down.serialize(out.subspan(written)) : 0;
+    return rest ? written + rest : 0;
+  }
+
+  std::ostream& serialize(std::ostream& out) {
+    if (lazy) {
+      beautify();
     }
-    for (int i = 0; i < int(precision) - int(temp.size()); ++i) {
-      ans += '0';
+    Up.serialize(out);
+    return Down.serialize(out);
+  }
+
+  // Чтение из in, возвращает число прочитанных байт (0, если запись
+  // обрезана или некорректна; x тогда не меняется)
+  static size_t deserialize(std::span<const std::byte> in, Rational& x) {
+    BigInteger up, down;
+    size_t read = BigInteger::deserialize(in, up);
+    if (read == 0) {
+      return 0;
     }
-    for (int i = 0; i < int(temp.size()); ++i) {
-      if (i == int(temp.size()) - int(precision)) {
-        ans += '.';
-      }
-      ans += temp[i];
+    size_t rest = BigInteger::deserialize(in.subspan(read), down);
+    if (rest == 0 || !x.assignParts(up, down)) {
+      return 0;
     }
-    return ans;
+    return read + rest;
   }
 
-  explicit operator double() { return std::atof(asDecimal(20).c_str()); }
+  // При ошибке выставляет failbit, x не меняется
+  static std::istream& deserialize(std::istream& in, Rational& x) {
+    BigInteger up, down;
+    if (BigInteger::deserialize(in, up) &&
+        BigInteger::deserialize(in, down) && !x.assignParts(up, down)) {
+      in.setstate(std::ios::failbit);
+    }
+    return in;
+  }
 };
 
 Rational operator-(const Rational& a, const Rational& b) {
@@ -576,26 +3236,68 @@ Rational operator-(const Rational& a, const Rational& b) {
   return result;
 }
 
+Rational operator-(Rational&& a, const Rational& b) {
+  a -= b;
+  return std::move(a);
+}
+
 Rational operator+(const Rational& a, const Rational& b) {
   Rational result = a;
   result += b;
   return result;
 }
 
+Rational operator+(Rational&& a, const Rational& b) {
+  a += b;
+  return std::move(a);
+}
+
+Rational operator+(const Rational& a, Rational&& b) {
+  b.lazy = a.lazy;
+  b += a;
+  return std::move(b);
+}
+
+Rational operator+(Rational&& a, Rational&& b) {
+  a += b;
+  return std::move(a);
+}
+
 Rational operator*(const Rational& a, const Rational& b) {
   Rational result = a;
   result *= b;
   return result;
 }
 
+Rational operator*(Rational&& a, const Rational& b) {
+  a *= b;
+  return std::move(a);
+}
+
+Rational operator*(const Rational& a, Rational&& b) {
+  b.lazy = a.lazy;
+  b *= a;
+  return std::move(b);
+}
+
+Rational operator*(Rational&& a, Rational&& b) {
+  a *= b;
+  return std::move(a);
+}
+
 Rational operator/(const Rational& a, const Rational& b) {
   Rational result = a;
   result /= b;
   return result;
 }
 
+Rational operator/(Rational&& a, const Rational& b) {
+  a /= b;
+  return std::move(a);
+}
+
 bool operator<(const Rational& a, const Rational& b) {
-  return a.Up * b.Down < a.Down * b.Up;
+  return Rational::compare(a, b) < 0;
 }
 
 bool operator>(const Rational& a, const Rational& b) { return b < a; }
@@ -605,7 +3307,7 @@ bool operator>=(const Rational& a, const Rational& b) { return !(a < b); }
 bool operator<=(const Rational& a, const Rational& b) { return !(b < a); }
 
 bool operator==(const Rational& a, const Rational& b) {
-  return a.Up * b.Down == a.Down * b.Up;
+  return Rational::compare(a, b) == 0;
 }
 
 bool operator!=(const Rational& a, const Rational& b) { return !(a == b); }